@@ -2,14 +2,64 @@
 // $id: SkeletonBinary.c https://github.com/zhongfq/spine-binaryreader $
 //
 
+#if !defined(_WIN32)
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+// _POSIX_C_SOURCE hides _SC_NPROCESSORS_ONLN on darwin
+#if defined(__APPLE__) && !defined(_DARWIN_C_SOURCE)
+#define _DARWIN_C_SOURCE
+#endif
+#ifndef SKELETONBINARY_NO_MMAP
+#define SKELETONBINARY_MMAP
+#endif
+#endif
+
 #include "SkeletonBinary.h"
+#include "SkeletonBinaryThread.h"
 #include "spine/extension.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
 #include <math.h>
 
+#ifndef _WIN32
+#include <unistd.h>
+#include <time.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SKELETONBINARY_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SKELETONBINARY_NEON
+#include <arm_neon.h>
+#endif
+
+// the varint fast path loads 8 bytes at once and needs them in little endian
+// order, SKELETONBINARY_NO_FAST_VARINT keeps the byte by byte decoder
+#if defined(SKELETONBINARY_NO_FAST_VARINT)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#define SKELETONBINARY_FAST_VARINT
+#include <intrin.h>
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SKELETONBINARY_FAST_VARINT
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SKELETONBINARY_BIG_ENDIAN
+#endif
+
+#ifdef SKELETONBINARY_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #define BONE_ROTATE     0
 #define BONE_TRANSLATE  1
 #define BONE_SCALE      2
@@ -26,7 +76,52 @@
 #define CURVE_STEPPED   1
 #define CURVE_BEZIER    2
 
-#define READ() ((int)((unsigned char)self->data->content[self->data->position++]))
+#define FORMAT_NONESSENTIAL 0x01
+#define FORMAT_CSTRINGS     0x02
+#define FORMAT_TOC          0x04
+#define FORMAT_NATIVE       0x08
+#define FORMAT_QUANTIZED    0x10
+#define FORMAT_TICKS        0x20
+
+#define SECTION_BONES           0
+#define SECTION_SLOTS           1
+#define SECTION_IK              2
+#define SECTION_TRANSFORM       3
+#define SECTION_PATH            4
+#define SECTION_DEFAULT_SKIN    5
+#define SECTION_SKINS           6
+#define SECTION_EVENTS          7
+#define SECTION_ANIMATIONS      8
+#define SECTION_COUNT           9
+
+#define STAGE_HEADER                0
+#define STAGE_BONES                 1
+#define STAGE_SLOTS                 2
+#define STAGE_IK_CONSTRAINTS        3
+#define STAGE_TRANSFORM_CONSTRAINTS 4
+#define STAGE_PATH_CONSTRAINTS      5
+#define STAGE_DEFAULT_SKIN          6
+#define STAGE_SKINS                 7
+#define STAGE_LINKED_MESHES         8
+#define STAGE_EVENTS                9
+#define STAGE_ANIMATIONS            10
+#define STAGE_DONE                  11
+
+#define STREAM_WINDOW_SIZE 4096
+
+#define SKELETONBINARY_MAX_THREADS  64
+
+#define ARENA_ALIGN         16
+#define ARENA_BLOCK_SIZE    (64 * 1024)
+
+// reference count in front of a shared heap deform frame, see shareFrame
+#define FRAME_HEADER_SIZE   ARENA_ALIGN
+
+
+static _spLock _lock = LOCK_INITIALIZER;
+
+#define READ() (self->data->position < self->data->capacity ? \
+    (int)((unsigned char)self->data->content[self->data->position++]) : readNext(self))
 
 typedef struct {
     const char* parent;
@@ -41,6 +136,16 @@ typedef struct {
     spTimeline **timelines;
 } _spTimelineArray;
 
+typedef struct {
+    float min;
+    float step;
+} _spQuantizer;
+
+typedef struct {
+    int rate;
+    int tick;
+} _spKeyTimes;
+
 typedef struct _spStringBuffer {
     struct _spStringBuffer *next;
     int position;
@@ -49,20 +154,477 @@ typedef struct _spStringBuffer {
 } _spStringBuffer;
 
 typedef struct {
+    unsigned int hash;
+    const char *string;
+} _spInternedString;
+
+// distinct strings of an arena load, where FREE is a no-op and one copy
+// can be handed to every attachment, slot and event that names it
+typedef struct {
+    int count;
+    int capacity;
+    _spInternedString *strings;
+} _spStringTable;
+
+typedef struct {
+    unsigned int hash;
+    int length;
+    const float *frame;
+    
+    // a heap frame the table holds a reference to, see retainFrame
+    bool counted;
+} _spSharedFrame;
+
+// distinct deform frames of a load, keyed by content, so a pose held over
+// several keys or reused by other animations is stored once. in an arena,
+// where FREE is a no-op, timelines just share them; on the heap each frame
+// carries a reference count the timelines release, see countDeformFrames
+typedef struct {
+    int count;
+    int capacity;
+    _spSharedFrame *frames;
+} _spFrameTable;
+
+typedef struct {
+    unsigned int hash;
+    const spSkin *skin;
+    int slotIndex;
+    const char *name;
+    spAttachment *attachment;
+} _spAttachmentKey;
+
+// (skin, slot, name) -> attachment for everything the load read, spSkin_getAttachment
+// walks the whole skin per call. names are copied into the index's own buffers
+typedef struct {
+    int count;
+    int capacity;
+    _spAttachmentKey *keys;
+    struct _spStringBuffer *names;
+} _spAttachmentIndex;
+
+// absolute offsets a FORMAT_TOC file lists right after its header: every
+// section, every named skin and every animation (with its duration)
+typedef struct {
+    int sections[SECTION_COUNT];
+    int skinsCount;
+    int *skins;
+    int animationsCount;
+    int *animations;
+    float *durations;
+} _spTableOfContents;
+
+struct spSkeletonBinary {
     float scale;
     
     _spStringBuffer *data;
     
+    // stream input, data is a refillable window over it when read is set,
+    // base is the file offset of the window's first byte
+    spSkeletonBinaryReadFunc read;
+    void *readUserData;
+    int windowSize;
+    int base;
+    
+    // strings are NUL terminated in the file, see FORMAT_CSTRINGS,
+    // bulk arrays are little endian and aligned, see FORMAT_NATIVE
+    bool cstrings;
+    bool native;
+    
+    // 8 or 16 bits per timeline value, 0 for floats, see FORMAT_QUANTIZED
+    int quantizeBits;
+    
+    // keyframe times are tick deltas at a per-animation rate, see FORMAT_TICKS
+    bool ticks;
+    
     _spStringBuffer *buffer;
+    _spStringTable strings;
+    _spFrameTable frames;
+    _spAttachmentIndex attachments;
+    
+    // the table a parallel decode worker stores its frames in, see decodeAnimationTask
+    _spFrameTable *sharedFrames;
+    
+    // growable scratch weighted vertices are decoded into before being copied out
+    int *bones;
+    int bonesCapacity;
+    float *weights;
+    int weightsCapacity;
+    
+    // a deform frame being decoded before shareFrame stores it
+    float *deform;
+    int deformCapacity;
     
     int linkedMeshCount;
     int linkedMeshCapacity;
     _spLinkedMesh* linkedMeshes;
     
+    // attachments waiting for configureAttachment, see deferConfigure
+    int deferredCount;
+    int deferredCapacity;
+    spAttachment **deferred;
+    
+    // only kept when the whole image is resident
+    _spTableOfContents *toc;
+    
+    // selective loading, skins holds every skin by its index in the file
+    // (NULL for the ones left out) for deform timelines to look them up
+    const spSkeletonBinaryOptions *options;
+    spSkin **skins;
+    
+    // readSkeleton's position, STAGE_*: the next item of the current
+    // section and the section's item count
+    int stage;
+    int stageIndex;
+    int stageLength;
+    
+    // lazy mode, animation i is still undecoded while animationOffsets[i] >= 0
+    bool lazy;
+    int *animationOffsets;
+    spSkeletonBinaryIndex *names;
+    spSkeletonBinaryArena *arena;
+    
+    // file image the reader opened, NULL when the caller owns it or
+    // adoptImage handed it to an arena. imageAdopted is set once names may
+    // point into data->content, see adoptImage and borrowContent
+    char *image;
+    int imageLength;
+    bool imageMapped;
+    bool imageAdopted;
+    
     // don't need free
     spSkeletonData *skeletonData;
     spAttachmentLoader *attachmentLoader;
-} spSkeletonBinary;
+};
+
+typedef struct _spArenaBlock {
+    struct _spArenaBlock *next;
+    size_t position;
+    size_t capacity;
+    char *content;
+} _spArenaBlock;
+
+// a mapped file image a cstrings load left to the arena, see adoptImage
+typedef struct _spArenaImage {
+    struct _spArenaImage *next;
+    char *content;
+    int length;
+} _spArenaImage;
+
+typedef struct {
+    const char *start;
+    const char *end;
+} _spArenaRange;
+
+struct spSkeletonBinaryArena {
+    size_t blockSize;
+    size_t size;
+    _spArenaBlock *blocks;
+    _spArenaImage *images;
+    
+    // the arena's blocks and adopted images sorted by address, so a free can
+    // tell arena memory from the heap's
+    _spArenaRange *ranges;
+    int rangesCount;
+    int rangesCapacity;
+    
+    // set while several threads allocate from the arena at once
+    bool shared;
+};
+
+static void *(*_heapMalloc)(size_t size) = malloc;
+static void (*_heapFree)(void *ptr) = free;
+
+// arena bound to the calling thread, see spSkeletonBinaryArena_bind
+static THREAD_LOCAL spSkeletonBinaryArena *_boundArena = NULL;
+
+// live arenas, the _malloc/_free hooks are installed while there is one
+static int _arenasCount = 0;
+static _spLock _arenaAllocLock = LOCK_INITIALIZER;
+
+static int findArenaRange(const spSkeletonBinaryArena *arena, const char *ptr)
+{
+    int lo = 0, hi = arena->rangesCount;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (arena->ranges[mid].end <= ptr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void addArenaRange(spSkeletonBinaryArena *arena, const char *start, size_t length)
+{
+    int index;
+    
+    if (arena->rangesCount == arena->rangesCapacity) {
+        arena->rangesCapacity = arena->rangesCapacity == 0 ? 16 : arena->rangesCapacity * 2;
+        arena->ranges = (_spArenaRange *)realloc(arena->ranges, sizeof(_spArenaRange) * arena->rangesCapacity);
+    }
+    index = findArenaRange(arena, start);
+    memmove(arena->ranges + index + 1, arena->ranges + index, sizeof(_spArenaRange) * (arena->rangesCount - index));
+    arena->ranges[index].start = start;
+    arena->ranges[index].end = start + length;
+    arena->rangesCount++;
+}
+
+static bool isArenaMemory(const spSkeletonBinaryArena *arena, const void *ptr)
+{
+    int index = findArenaRange(arena, (const char *)ptr);
+    return index < arena->rangesCount && arena->ranges[index].start <= (const char *)ptr;
+}
+
+static void *arenaAlloc(spSkeletonBinaryArena *arena, size_t size)
+{
+    _spArenaBlock *block = arena->blocks;
+    void *ptr;
+    
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size == 0) {
+        size = ARENA_ALIGN;
+    }
+    
+    if (block == NULL || block->capacity - block->position < size) {
+        size_t capacity = MAX(arena->blockSize, size);
+        size_t header = (sizeof(_spArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+        block = (_spArenaBlock *)_heapMalloc(header + capacity);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->position = 0;
+        block->capacity = capacity;
+        block->content = (char *)block + header;
+        addArenaRange(arena, block->content, capacity);
+        
+        // an oversized request gets its own block, keep bumping the current one
+        if (capacity > arena->blockSize && arena->blocks != NULL) {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        } else {
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+        arena->size += capacity;
+    }
+    
+    ptr = block->content + block->position;
+    block->position += size;
+    return ptr;
+}
+
+static void *arenaMalloc(size_t size)
+{
+    spSkeletonBinaryArena *arena = _boundArena;
+    if (arena != NULL) {
+        void *ptr;
+        if (!arena->shared) {
+            return arenaAlloc(arena, size);
+        }
+        LOCK(_arenaAllocLock);
+        ptr = arenaAlloc(arena, size);
+        UNLOCK(_arenaAllocLock);
+        return ptr;
+    }
+    return _heapMalloc(size);
+}
+
+static void arenaFree(void *ptr)
+{
+    spSkeletonBinaryArena *arena = _boundArena;
+    
+    if (ptr == NULL) {
+        return;
+    }
+    
+    // only the bound arena's memory is looked up, a thread without one frees
+    // straight into the heap. arena memory and adopted images are released as
+    // a whole by spSkeletonBinaryArena_dispose
+    if (arena != NULL) {
+        bool owned;
+        if (!arena->shared) {
+            owned = isArenaMemory(arena, ptr);
+        } else {
+            LOCK(_arenaAllocLock);
+            owned = isArenaMemory(arena, ptr);
+            UNLOCK(_arenaAllocLock);
+        }
+        if (owned) {
+            return;
+        }
+    }
+    _heapFree(ptr);
+}
+
+bool spSkeletonBinaryArena_setAllocator(void *(*mallocFunc)(size_t size), void (*freeFunc)(void *ptr))
+{
+    bool set;
+    
+    // the hooks read the heap functions without a lock, they can only change
+    // while no arena is alive
+    LOCK(_lock);
+    set = _arenasCount == 0;
+    if (set) {
+        _heapMalloc = mallocFunc;
+        _heapFree = freeFunc;
+        _setMalloc(mallocFunc);
+        _setFree(freeFunc);
+    }
+    UNLOCK(_lock);
+    return set;
+}
+
+spSkeletonBinaryArena *spSkeletonBinaryArena_create(size_t blockSize)
+{
+    spSkeletonBinaryArena *self = (spSkeletonBinaryArena *)malloc(sizeof(spSkeletonBinaryArena));
+    self->blockSize = blockSize > 0 ? blockSize : ARENA_BLOCK_SIZE;
+    self->size = 0;
+    self->blocks = NULL;
+    self->images = NULL;
+    self->ranges = NULL;
+    self->rangesCount = 0;
+    self->rangesCapacity = 0;
+    self->shared = false;
+    
+    LOCK(_lock);
+    if (_arenasCount++ == 0) {
+        _setMalloc(arenaMalloc);
+        _setFree(arenaFree);
+    }
+    UNLOCK(_lock);
+    
+    return self;
+}
+
+void spSkeletonBinaryArena_dispose(spSkeletonBinaryArena *self)
+{
+    // the last arena hands _malloc/_free back to the heap
+    LOCK(_lock);
+    if (--_arenasCount == 0) {
+        _setMalloc(_heapMalloc);
+        _setFree(_heapFree);
+    }
+    UNLOCK(_lock);
+    
+    while (self->blocks) {
+        _spArenaBlock *next = self->blocks->next;
+        _heapFree(self->blocks);
+        self->blocks = next;
+    }
+#ifdef SKELETONBINARY_MMAP
+    while (self->images) {
+        _spArenaImage *next = self->images->next;
+        munmap(self->images->content, (size_t)self->images->length);
+        free(self->images);
+        self->images = next;
+    }
+#endif
+    free(self->ranges);
+    free(self);
+}
+
+size_t spSkeletonBinaryArena_getSize(const spSkeletonBinaryArena *self)
+{
+    return self->size;
+}
+
+spSkeletonBinaryArena *spSkeletonBinaryArena_bind(spSkeletonBinaryArena *self)
+{
+    spSkeletonBinaryArena *previous = _boundArena;
+    _boundArena = self;
+    return previous;
+}
+
+static bool fillWindow(spSkeletonBinary *self, int count)
+{
+    _spStringBuffer *data = self->data;
+    int keep;
+    
+    if (self->read == NULL) {
+        return data->capacity - data->position >= count;
+    }
+    
+    keep = data->position;
+    if (keep > 0) {
+        memmove(data->content, data->content + keep, data->capacity - keep);
+        data->capacity -= keep;
+        data->position -= keep;
+        self->base += keep;
+    }
+    
+    if (data->position + count > self->windowSize) {
+        self->windowSize = MAX(self->windowSize * 2, data->position + count);
+        data->content = (char *)realloc(data->content, self->windowSize);
+    }
+    
+    while (data->capacity - data->position < count) {
+        int n = self->read(self->readUserData, data->content + data->capacity, self->windowSize - data->capacity);
+        if (n <= 0) {
+            break;
+        }
+        data->capacity += n;
+    }
+    
+    return data->capacity - data->position >= count;
+}
+
+static int readNext(spSkeletonBinary *self)
+{
+    // past the end of a truncated file every byte reads as 0
+    if (!fillWindow(self, 1)) {
+        return 0;
+    }
+    return (int)((unsigned char)self->data->content[self->data->position++]);
+}
+
+static void skipBytes(spSkeletonBinary *self, int count)
+{
+    while (count > 0) {
+        int n = self->data->capacity - self->data->position;
+        if (n == 0) {
+            if (!fillWindow(self, 1)) {
+                return;
+            }
+            continue;
+        }
+        n = MIN(n, count);
+        self->data->position += n;
+        count -= n;
+    }
+}
+
+// copies count raw bytes, what a truncated file lacks reads as 0
+static void readBytes(spSkeletonBinary *self, void *dest, int count)
+{
+    char *p = (char *)dest;
+    
+    while (count > 0) {
+        _spStringBuffer *data = self->data;
+        int n = data->capacity - data->position;
+        if (n == 0) {
+            if (!fillWindow(self, 1)) {
+                memset(p, 0, count);
+                return;
+            }
+            continue;
+        }
+        n = MIN(n, count);
+        memcpy(p, data->content + data->position, n);
+        data->position += n;
+        p += n;
+        count -= n;
+    }
+}
+
+// bulk arrays of the native layout start 16 byte aligned from the start of the file
+static inline void alignArray(spSkeletonBinary *self)
+{
+    int padding = -(self->base + self->data->position) & 15;
+    if (padding > 0) {
+        skipBytes(self, padding);
+    }
+}
 
 static inline bool readBoolean(spSkeletonBinary *self)
 {
@@ -92,10 +654,58 @@ static inline int readInt(spSkeletonBinary *self)
     return ((ch1 << 24) | (ch2 << 16) | (ch3 << 8) | (ch4 << 0));
 }
 
+#ifdef SKELETONBINARY_FAST_VARINT
+static inline int countTrailingZeros(uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (int)index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+#endif
+
 static inline int readVarint(spSkeletonBinary *self, bool optimizePositive)
 {
+    unsigned int result;
+    
+#ifdef SKELETONBINARY_FAST_VARINT
+    _spStringBuffer *data = self->data;
+    if (data->capacity - data->position >= 8) {
+        // most varints are counts and bone indices that fit in one byte,
+        // the others find their terminating byte among the first five
+        // without branching on each one and gather the 7-bit groups with
+        // shifts and masks
+        static const uint64_t masks[] = {
+            0, 0x7F, 0x7F7F, 0x7F7F7F, 0x7F7F7F7F, 0x7F7F7F7F7F
+        };
+        uint64_t word;
+        uint64_t stops;
+        int length;
+        
+        result = (unsigned char)data->content[data->position];
+        if (result < 0x80) {
+            data->position++;
+            return (int)(optimizePositive ? result : ((result >> 1) ^ -(result & 1)));
+        }
+        memcpy(&word, data->content + data->position, sizeof(word));
+        stops = ~word & 0x8080808080ULL;
+        length = stops ? (countTrailingZeros(stops) >> 3) + 1 : 5;
+        word &= masks[length];
+        result = (unsigned int)((word & 0x7F)
+            | ((word >> 1) & 0x3F80)
+            | ((word >> 2) & 0x1FC000)
+            | ((word >> 3) & 0xFE00000)
+            | ((word >> 4) & 0x7F0000000ULL));
+        data->position += length;
+        return (int)(optimizePositive ? result : ((result >> 1) ^ -(result & 1)));
+    }
+#endif
+    
     int b = READ();
-    unsigned int result = b & 0x7F;
+    result = b & 0x7F;
     if ((b & 0x80) != 0) {
         b = READ();
         result |= (b & 0x7F) << 7;
@@ -126,32 +736,57 @@ static inline float readFloat(spSkeletonBinary *self)
     return u.f;
 }
 
-static inline char *readString(spSkeletonBinary *self)
+static char *allocString(_spStringBuffer **buffers, int byteCount)
+{
+    _spStringBuffer *buffer = *buffers;
+    char *start;
+    
+    if (buffer == NULL || buffer->capacity - buffer->position < byteCount) {
+        buffer = (_spStringBuffer *)malloc(sizeof(_spStringBuffer));
+        buffer->position = 0;
+        buffer->capacity = MAX(BUFSIZ * 2, byteCount);
+        buffer->content = (char *)malloc(buffer->capacity);
+        buffer->next = *buffers;
+        *buffers = buffer;
+    }
+    
+    start = buffer->content + buffer->position;
+    buffer->position += byteCount;
+    return start;
+}
+
+static inline const char *readString(spSkeletonBinary *self)
 {
+    _spStringBuffer *data = self->data;
     char *start, *end;
-    _spStringBuffer *buffer = self->buffer;
     int byteCount = readVarint(self, true);
  
     if (byteCount == 0) {
         return NULL;
     }
     
-    if (buffer == NULL || buffer->capacity - buffer->position < byteCount) {
-        self->buffer = (_spStringBuffer *)malloc(sizeof(_spStringBuffer));
-        self->buffer->position = 0;
-        self->buffer->capacity = MAX(BUFSIZ * 2, byteCount);
-        self->buffer->content = (char *)malloc(self->buffer->capacity);
-        self->buffer->next = buffer;
-        buffer = self->buffer;
+    if (self->cstrings) {
+        // byteCount includes the NUL the converter wrote, a resident image
+        // can hand the string out as is
+        if (!fillWindow(self, byteCount) || data->content[data->position + byteCount - 1] != '\0') {
+            data->position = data->capacity;
+            return NULL;
+        }
+        start = data->content + data->position;
+        data->position += byteCount;
+        if (self->read) {
+            // the window moves on the next refill
+            start = (char *)memcpy(allocString(&self->buffer, byteCount), start, byteCount);
+        }
+        return start;
     }
     
-    start = buffer->content + buffer->position;
+    start = allocString(&self->buffer, byteCount);
     end = start;
     while (--byteCount) {
         *end++ =(char)READ();
     }
-    *end++ = '\0';
-    buffer->position += (int)(end - start);
+    *end = '\0';
     
     return start;
 }
@@ -166,95 +801,479 @@ static const char *copyString(const char *src) {
     return dest;
 }
 
-static inline float *readFloats(spSkeletonBinary *self, float scale, size_t length)
+// byte swaps count big endian floats from src and multiplies them by scale
+static void decodeFloats(float *dest, const unsigned char *src, int count, float scale)
 {
-    float *arr = MALLOC(float, length);
-    for (int i = 0; i < length; i++)
-    {
-        arr[i] = readFloat(self) * scale;
+    int i = 0;
+    
+#if defined(SKELETONBINARY_SSE2)
+    __m128 factor = _mm_set1_ps(scale);
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_castsi128_ps(v), factor));
+    }
+#elif defined(SKELETONBINARY_NEON)
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t v = vrev32q_u8(vld1q_u8(src + i * 4));
+        vst1q_f32(dest + i, vmulq_n_f32(vreinterpretq_f32_u8(v), scale));
+    }
+#endif
+    
+    for (; i < count; i++) {
+        const unsigned char *p = src + i * 4;
+        union {
+            float f;
+            unsigned int i;
+        } u;
+        
+        u.i = ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+        dest[i] = u.f * scale;
     }
-
-    return arr;
 }
 
-static inline unsigned short *readShorts(spSkeletonBinary *self, size_t length)
+// decodes as many floats as the window holds at once, so a stream only
+// falls back to refilling between chunks
+static void readFloatArray(spSkeletonBinary *self, float *arr, int length, float scale)
 {
-    unsigned short *arr = MALLOC(unsigned short, length);
-    for (int i = 0; i < length; i++)
-    {
-        arr[i] = readShort(self);
+    if (self->native) {
+        alignArray(self);
+        readBytes(self, arr, sizeof(float) * length);
+#ifdef SKELETONBINARY_BIG_ENDIAN
+        for (int i = 0; i < length; i++) {
+            unsigned char *p = (unsigned char *)(arr + i);
+            unsigned char t0 = p[0], t1 = p[1];
+            p[0] = p[3];
+            p[1] = p[2];
+            p[2] = t1;
+            p[3] = t0;
+        }
+#endif
+        if (scale != 1) {
+            for (int i = 0; i < length; i++) {
+                arr[i] *= scale;
+            }
+        }
+        return;
+    }
+    
+    while (length > 0) {
+        _spStringBuffer *data = self->data;
+        int n = (data->capacity - data->position) >> 2;
+        if (n == 0) {
+            if (!fillWindow(self, 4)) {
+                // past the end of a truncated file every float reads as 0
+                memset(arr, 0, sizeof(float) * length);
+                data->position = data->capacity;
+                return;
+            }
+            continue;
+        }
+        n = MIN(n, length);
+        decodeFloats(arr, (const unsigned char *)data->content + data->position, n, scale);
+        data->position += n << 2;
+        arr += n;
+        length -= n;
     }
+}
 
-    return arr;
+static unsigned int hashString(const char *str, size_t *length)
+{
+    // FNV-1a
+    const char *p = str;
+    unsigned int hash = 2166136261u;
+    while (*p) {
+        hash = (hash ^ (unsigned char)*p++) * 16777619u;
+    }
+    *length = (size_t)(p - str);
+    return hash;
 }
 
-static inline void readColor(spSkeletonBinary *self, float *r, float *g, float *b, float *a)
+static void growStringTable(_spStringTable *table)
 {
-    *r = READ() / (float)255;
-    *g = READ() / (float)255;
-    *b = READ() / (float)255;
-    *a = READ() / (float)255;
+    _spInternedString *strings = table->strings;
+    int capacity = table->capacity;
+    
+    table->capacity = capacity == 0 ? 256 : capacity * 2;
+    table->strings = (_spInternedString *)calloc(table->capacity, sizeof(_spInternedString));
+    for (int i = 0; i < capacity; i++) {
+        if (strings[i].string) {
+            int index = strings[i].hash & (table->capacity - 1);
+            while (table->strings[index].string) {
+                index = (index + 1) & (table->capacity - 1);
+            }
+            table->strings[index] = strings[i];
+        }
+    }
+    free(strings);
 }
 
-static void addLinkedMesh (spSkeletonBinary* self, spMeshAttachment* mesh, const char* skin, int slotIndex, const char* parent) {
-    _spLinkedMesh* linkedMesh;
+// returns the one copy of str shared by an arena load, the caller stores it
+// wherever the runtime would keep its own MALLOC_STR copy. a heap load gets a
+// MALLOC_STR copy of its own, the runtime FREEs each one
+static const char *internString(spSkeletonBinary *self, const char *str)
+{
+    _spStringTable *table = &self->strings;
+    _spInternedString *entry;
+    size_t length;
+    unsigned int hash;
+    int index;
+    char *copy;
     
-    if (self->linkedMeshCapacity == 0 || self->linkedMeshCount == self->linkedMeshCapacity) {
-        self->linkedMeshCapacity = self->linkedMeshCapacity == 0 ? 8 : self->linkedMeshCapacity * 2;
-        self->linkedMeshes = (_spLinkedMesh *)realloc(self->linkedMeshes, sizeof(_spLinkedMesh) * self->linkedMeshCapacity);
+    // read in place from an image the arena keeps mapped
+    if (self->imageAdopted && str >= self->data->content && str < self->data->content + self->data->capacity) {
+        return str;
+    }
+    if (str == NULL || !_boundArena) {
+        return copyString(str);
     }
     
-    linkedMesh = self->linkedMeshes + self->linkedMeshCount++;
-    linkedMesh->mesh = mesh;
-    linkedMesh->skin = skin;
-    linkedMesh->slotIndex = slotIndex;
-    linkedMesh->parent = parent;
+    hash = hashString(str, &length);
+    if ((table->count + 1) * 2 > table->capacity) {
+        growStringTable(table);
+    }
+    
+    index = hash & (table->capacity - 1);
+    while ((entry = table->strings + index)->string) {
+        if (entry->hash == hash && strcmp(entry->string, str) == 0) {
+            return entry->string;
+        }
+        index = (index + 1) & (table->capacity - 1);
+    }
+    
+    copy = MALLOC(char, length + 1);
+    memcpy(copy, str, length + 1);
+    
+    entry->hash = hash;
+    entry->string = copy;
+    table->count++;
+    
+    return copy;
 }
 
-static void readVertices(spSkeletonBinary *self, spVertexAttachment *attachment, int vertexCount)
+static void freeStringTable(_spStringTable *table)
 {
-    if (!readBoolean(self)) {
-        attachment->vertices = readFloats(self, self->scale, vertexCount << 1);
-        attachment->verticesCount = vertexCount << 1;
-        attachment->bones = NULL;
-        attachment->bonesCount = 0;
-    } else {
-        float *weights;
-        int *bones;
-        int weightCount = 0, boneCount = 0;
-        int position = self->data->position;
-        
-        for (int i = 0; i < vertexCount; i++) {
-            int nn = readVarint(self, true);
-            boneCount++;
-            for (int ii = 0; ii < nn; ii++) {
-                readVarint(self, true);
-                self->data->position += sizeof(float) * 3;
-                weightCount += 3;
-                boneCount++;
+    free(table->strings);
+    table->strings = NULL;
+    table->count = 0;
+    table->capacity = 0;
+}
+
+static unsigned int hashFrame(const float *frame, int length)
+{
+    // FNV-1a over the bit patterns
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        uint32_t bits;
+        memcpy(&bits, frame + i, sizeof(bits));
+        hash = (hash ^ bits) * 16777619u;
+    }
+    return (hash ^ (unsigned int)length) * 16777619u;
+}
+
+static void growFrameTable(_spFrameTable *table)
+{
+    _spSharedFrame *frames = table->frames;
+    int capacity = table->capacity;
+    
+    table->capacity = capacity == 0 ? 256 : capacity * 2;
+    table->frames = (_spSharedFrame *)calloc(table->capacity, sizeof(_spSharedFrame));
+    for (int i = 0; i < capacity; i++) {
+        if (frames[i].frame) {
+            int index = frames[i].hash & (table->capacity - 1);
+            while (table->frames[index].frame) {
+                index = (index + 1) & (table->capacity - 1);
             }
+            table->frames[index] = frames[i];
         }
-        
-        self->data->position = position;
-        
-        attachment->bones = MALLOC(int, boneCount);
-        attachment->bonesCount = boneCount;
-        attachment->vertices = MALLOC(float, weightCount);
-        attachment->verticesCount = weightCount;
-        weights = attachment->vertices;
-        bones = attachment->bones;
+    }
+    free(frames);
+}
+
+static int *frameRefCount(const float *frame)
+{
+    return (int *)((char *)frame - FRAME_HEADER_SIZE);
+}
+
+static void retainFrame(const float *frame)
+{
+    (*frameRefCount(frame))++;
+}
+
+static void releaseFrame(const float *frame)
+{
+    if (--*frameRefCount(frame) == 0) {
+        FREE(frameRefCount(frame));
+    }
+}
+
+static _spLock _framesLock = LOCK_INITIALIZER;
+
+static const float *storeFrame(_spFrameTable *table, const float *frame, int length, unsigned int hash)
+{
+    _spSharedFrame *entry;
+    bool counted = _boundArena == NULL;
+    float *copy;
+    int index;
+    
+    if ((table->count + 1) * 2 > table->capacity) {
+        growFrameTable(table);
+    }
+    
+    index = hash & (table->capacity - 1);
+    while ((entry = table->frames + index)->frame) {
+        if (entry->hash == hash && entry->length == length && memcmp(entry->frame, frame, sizeof(float) * length) == 0) {
+            if (entry->counted) {
+                retainFrame(entry->frame);
+            }
+            return entry->frame;
+        }
+        index = (index + 1) & (table->capacity - 1);
+    }
+    
+    if (counted) {
+        // one reference for the table, one for the caller
+        char *block = MALLOC(char, FRAME_HEADER_SIZE + sizeof(float) * MAX(length, 1));
+        copy = (float *)(block + FRAME_HEADER_SIZE);
+        *frameRefCount(copy) = 2;
+    } else {
+        copy = MALLOC(float, MAX(length, 1));
+    }
+    memcpy(copy, frame, sizeof(float) * length);
+    
+    entry->hash = hash;
+    entry->length = length;
+    entry->frame = copy;
+    entry->counted = counted;
+    table->count++;
+    
+    return copy;
+}
+
+// the stored copy of a deform frame, shared with every identical frame of
+// the load. on the heap the caller gets a reference of its own to release
+static const float *shareFrame(spSkeletonBinary *self, const float *frame, int length)
+{
+    unsigned int hash = hashFrame(frame, length);
+    const float *shared;
+    
+    if (self->sharedFrames == NULL) {
+        return storeFrame(&self->frames, frame, length, hash);
+    }
+    
+    // animations decoded in parallel share frames with each other too
+    LOCK(_framesLock);
+    shared = storeFrame(self->sharedFrames, frame, length, hash);
+    UNLOCK(_framesLock);
+    return shared;
+}
+
+static void freeFrameTable(_spFrameTable *table)
+{
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->frames[i].frame && table->frames[i].counted) {
+            releaseFrame(table->frames[i].frame);
+        }
+    }
+    free(table->frames);
+    table->frames = NULL;
+    table->count = 0;
+    table->capacity = 0;
+}
+
+// spine's own dispose of a deform timeline, taken from the first one
+// countDeformFrames sees. it is the same for every deform timeline
+static void (*_disposeDeformTimeline)(spTimeline *self) = NULL;
+
+static void disposeCountedDeformTimeline(spTimeline *timeline)
+{
+    spDeformTimeline *self = SUB_CAST(spDeformTimeline, timeline);
+    
+    for (int i = 0; i < self->framesCount; i++) {
+        if (self->frameVertices[i]) {
+            releaseFrame(self->frameVertices[i]);
+            self->frameVertices[i] = NULL;
+        }
+    }
+    _disposeDeformTimeline(timeline);
+}
+
+// a heap load's deform timeline holds shared, reference counted frames; it
+// releases them when disposed instead of FREEing each one
+static void countDeformFrames(spDeformTimeline *timeline)
+{
+    _spTimelineVtable *vtable = VTABLE(spTimeline, timeline);
+    
+    LOCK(_lock);
+    if (_disposeDeformTimeline == NULL) {
+        _disposeDeformTimeline = vtable->dispose;
+    }
+    UNLOCK(_lock);
+    vtable->dispose = disposeCountedDeformTimeline;
+}
+
+static inline float *readFloats(spSkeletonBinary *self, float scale, size_t length)
+{
+    float *arr = MALLOC(float, length);
+    readFloatArray(self, arr, (int)length, scale);
+    return arr;
+}
+
+static inline unsigned short *readShorts(spSkeletonBinary *self, size_t length)
+{
+    unsigned short *arr = MALLOC(unsigned short, length);
+    
+    if (self->native) {
+        alignArray(self);
+        readBytes(self, arr, (int)(sizeof(unsigned short) * length));
+#ifdef SKELETONBINARY_BIG_ENDIAN
+        for (int i = 0; i < length; i++) {
+            arr[i] = (unsigned short)((arr[i] >> 8) | (arr[i] << 8));
+        }
+#endif
+        return arr;
+    }
+    
+    for (int i = 0; i < length; i++)
+    {
+        arr[i] = readShort(self);
+    }
+
+    return arr;
+}
+
+static void skipFloatArray(spSkeletonBinary *self, int length)
+{
+    if (self->native) {
+        alignArray(self);
+    }
+    skipBytes(self, sizeof(float) * length);
+}
+
+static void skipShortArray(spSkeletonBinary *self, int length)
+{
+    if (self->native) {
+        alignArray(self);
+    }
+    skipBytes(self, sizeof(short) * length);
+}
+
+static inline void readColor(spSkeletonBinary *self, float *r, float *g, float *b, float *a)
+{
+    *r = READ() / (float)255;
+    *g = READ() / (float)255;
+    *b = READ() / (float)255;
+    *a = READ() / (float)255;
+}
+
+static inline void skipString(spSkeletonBinary *self)
+{
+    int byteCount = readVarint(self, true);
+    if (byteCount > 0) {
+        skipBytes(self, self->cstrings ? byteCount : byteCount - 1);
+    }
+}
+
+static void freeStringBuffers(_spStringBuffer **buffers)
+{
+    while(*buffers) {
+        _spStringBuffer *next = (*buffers)->next;
+        free((*buffers)->content);
+        free(*buffers);
+        *buffers = next;
+    }
+}
+
+static void resetStringBuffers(spSkeletonBinary *self)
+{
+    // strings returned by readString are scratch, the newest buffer is kept for reuse
+    if (self->buffer) {
+        while (self->buffer->next) {
+            _spStringBuffer *next = self->buffer->next;
+            self->buffer->next = next->next;
+            free(next->content);
+            free(next);
+        }
+        self->buffer->position = 0;
+    }
+}
+
+static void addLinkedMesh (spSkeletonBinary* self, spMeshAttachment* mesh, const char* skin, int slotIndex, const char* parent) {
+    _spLinkedMesh* linkedMesh;
+    
+    if (self->linkedMeshCapacity == 0 || self->linkedMeshCount == self->linkedMeshCapacity) {
+        self->linkedMeshCapacity = self->linkedMeshCapacity == 0 ? 8 : self->linkedMeshCapacity * 2;
+        self->linkedMeshes = (_spLinkedMesh *)realloc(self->linkedMeshes, sizeof(_spLinkedMesh) * self->linkedMeshCapacity);
+    }
+    
+    linkedMesh = self->linkedMeshes + self->linkedMeshCount++;
+    linkedMesh->mesh = mesh;
+    linkedMesh->skin = skin;
+    linkedMesh->slotIndex = slotIndex;
+    linkedMesh->parent = parent;
+}
+
+static void readVertices(spSkeletonBinary *self, spVertexAttachment *attachment, int vertexCount)
+{
+    if (!readBoolean(self)) {
+        attachment->vertices = readFloats(self, self->scale, vertexCount << 1);
+        attachment->verticesCount = vertexCount << 1;
+        attachment->bones = NULL;
+        attachment->bonesCount = 0;
+    } else {
+        int weightCount = 0, boneCount = 0;
         
         for (int i = 0; i < vertexCount; i++) {
             int nn = readVarint(self, true);
-            *bones++ = nn;
+            
+            if (boneCount + nn + 1 > self->bonesCapacity) {
+                self->bonesCapacity = MAX(self->bonesCapacity * 2, MAX(boneCount + nn + 1, 256));
+                self->bones = (int *)realloc(self->bones, sizeof(int) * self->bonesCapacity);
+            }
+            if (weightCount + nn * 3 > self->weightsCapacity) {
+                self->weightsCapacity = MAX(self->weightsCapacity * 2, MAX(weightCount + nn * 3, 768));
+                self->weights = (float *)realloc(self->weights, sizeof(float) * self->weightsCapacity);
+            }
+            
+            self->bones[boneCount++] = nn;
             for (int ii = 0; ii < nn; ii++) {
-                *bones++ = readVarint(self, true);
-                *weights++ = readFloat(self) * self->scale;
-                *weights++ = readFloat(self) * self->scale;
-                *weights++ = readFloat(self);
+                self->bones[boneCount++] = readVarint(self, true);
+                self->weights[weightCount++] = readFloat(self) * self->scale;
+                self->weights[weightCount++] = readFloat(self) * self->scale;
+                self->weights[weightCount++] = readFloat(self);
             }
         }
+        
+        attachment->bones = MALLOC(int, boneCount);
+        attachment->bonesCount = boneCount;
+        attachment->vertices = MALLOC(float, weightCount);
+        attachment->verticesCount = weightCount;
+        memcpy(attachment->bones, self->bones, sizeof(int) * boneCount);
+        memcpy(attachment->vertices, self->weights, sizeof(float) * weightCount);
+    }
+}
+
+static void configureAttachment(spSkeletonBinary *self, spAttachment *attachment)
+{
+    if (self->options == NULL || !self->options->deferConfigure) {
+        spAttachmentLoader_configureAttachment(self->attachmentLoader, attachment);
+        return;
+    }
+    if (self->deferredCount == self->deferredCapacity) {
+        self->deferredCapacity = MAX(self->deferredCapacity * 2, 64);
+        self->deferred = (spAttachment **)realloc(self->deferred, sizeof(spAttachment *) * self->deferredCapacity);
+    }
+    self->deferred[self->deferredCount++] = attachment;
+}
+
+// the batch deferConfigure holds back, in the order they were read
+static void configureDeferredAttachments(spSkeletonBinary *self)
+{
+    for (int i = 0; i < self->deferredCount; i++) {
+        spAttachmentLoader_configureAttachment(self->attachmentLoader, self->deferred[i]);
     }
+    self->deferredCount = 0;
 }
 
 static spAttachment *readAttachment(spSkeletonBinary *self, spSkin *skin, int slotIndex, const char *attachmentName)
@@ -262,20 +1281,20 @@ static spAttachment *readAttachment(spSkeletonBinary *self, spSkin *skin, int sl
     spAttachment *attachment = NULL;
     float scale = self->scale;
     
-    char *name = readString(self);
-    if (name == NULL) name = (char *)attachmentName;
+    const char *name = readString(self);
+    if (name == NULL) name = attachmentName;
     
     switch ((spAttachmentType)readByte(self)) {
         case SP_ATTACHMENT_REGION: {
             spRegionAttachment *region;
             
-            char *path = readString(self);
+            const char *path = readString(self);
             if (path == NULL) path = name;
             
             attachment = spAttachmentLoader_createAttachment(self->attachmentLoader, skin, SP_ATTACHMENT_REGION, name, path);
             region = SUB_CAST(spRegionAttachment, attachment);
             if (path) {
-                region->path = copyString(path);
+                region->path = internString(self, path);
             }
             
             region->rotation = readFloat(self);
@@ -288,7 +1307,7 @@ static spAttachment *readAttachment(spSkeletonBinary *self, spSkin *skin, int sl
             readColor(self, &region->r, &region->g, &region->b, &region->a);
             
             spRegionAttachment_updateOffset(region);
-            spAttachmentLoader_configureAttachment(self->attachmentLoader, attachment);
+            configureAttachment(self, attachment);
             break;
         }
         case SP_ATTACHMENT_BOUNDING_BOX: {
@@ -300,7 +1319,7 @@ static spAttachment *readAttachment(spSkeletonBinary *self, spSkin *skin, int sl
             readVertices(self, SUPER(boundingBox), vertexCount);
             SUPER(boundingBox)->worldVerticesLength = vertexCount << 1;
             
-            spAttachmentLoader_configureAttachment(self->attachmentLoader, attachment);
+            configureAttachment(self, attachment);
             
             break;
         }
@@ -308,13 +1327,13 @@ static spAttachment *readAttachment(spSkeletonBinary *self, spSkin *skin, int sl
             spMeshAttachment *mesh;
             int vertexCount;
             
-            char *path = readString(self);
+            const char *path = readString(self);
             if (path == NULL) path = name;
             
             attachment = spAttachmentLoader_createAttachment(self->attachmentLoader, skin, SP_ATTACHMENT_MESH, name, path);
             mesh = SUB_CAST(spMeshAttachment, attachment);
             if (path) {
-                mesh->path = copyString(path);
+                mesh->path = internString(self, path);
             }
             
             readColor(self, &mesh->r, &mesh->g, &mesh->b, &mesh->a);
@@ -327,21 +1346,21 @@ static spAttachment *readAttachment(spSkeletonBinary *self, spSkin *skin, int sl
             mesh->hullLength = readVarint(self, true) << 1;
             
             spMeshAttachment_updateUVs(mesh);
-            spAttachmentLoader_configureAttachment(self->attachmentLoader, attachment);
+            configureAttachment(self, attachment);
             break;
         }
         case SP_ATTACHMENT_LINKED_MESH: {
             spMeshAttachment *mesh;
             
-            char *parent;
-            char *skinName;
-            char *path = readString(self);
+            const char *parent;
+            const char *skinName;
+            const char *path = readString(self);
             if (path == NULL) path = name;
             
             attachment = spAttachmentLoader_createAttachment(self->attachmentLoader, skin, SP_ATTACHMENT_LINKED_MESH, name, path);
             mesh = SUB_CAST(spMeshAttachment, attachment);
             if (path) {
-                mesh->path = copyString(path);
+                mesh->path = internString(self, path);
             }
             
             readColor(self, &mesh->r, &mesh->g, &mesh->b, &mesh->a);
@@ -366,17 +1385,109 @@ static spAttachment *readAttachment(spSkeletonBinary *self, spSkin *skin, int sl
             SUPER(path)->worldVerticesLength = vertexCount << 1;
             path->lengthsLength = vertexCount / 3;
             path->lengths = MALLOC(float, path->lengthsLength);
-            for (int i = 0; i < path->lengthsLength; i++) {
-                path->lengths[i] = readFloat(self) * self->scale;
-            }
+            readFloatArray(self, path->lengths, path->lengthsLength, self->scale);
             
             break;
         }
     }
     
+    // the same attachment name shows up in every skin and attachment timeline.
+    // only an arena load interns, on the heap the loader's copy is kept as is
+    if (attachment && _boundArena) {
+        FREE(attachment->name);
+        CONST_CAST(const char *, attachment->name) = internString(self, name);
+    }
+    
     return attachment;
 }
 
+static unsigned int hashAttachmentKey(const spSkin *skin, int slotIndex, const char *name)
+{
+    size_t length;
+    unsigned int hash = hashString(name, &length);
+    hash = (hash ^ (unsigned int)slotIndex) * 16777619u;
+    return (hash ^ (unsigned int)((uintptr_t)skin >> 4)) * 16777619u;
+}
+
+static void growAttachmentIndex(_spAttachmentIndex *index)
+{
+    _spAttachmentKey *keys = index->keys;
+    int capacity = index->capacity;
+    
+    index->capacity = capacity == 0 ? 256 : capacity * 2;
+    index->keys = (_spAttachmentKey *)calloc(index->capacity, sizeof(_spAttachmentKey));
+    for (int i = 0; i < capacity; i++) {
+        if (keys[i].skin) {
+            int slot = keys[i].hash & (index->capacity - 1);
+            while (index->keys[slot].skin) {
+                slot = (slot + 1) & (index->capacity - 1);
+            }
+            index->keys[slot] = keys[i];
+        }
+    }
+    free(keys);
+}
+
+// a later attachment under the same key replaces the earlier one, like
+// spSkin_getAttachment finding the newest entry first
+static void indexAttachment(_spAttachmentIndex *index, const spSkin *skin, int slotIndex, const char *name, spAttachment *attachment)
+{
+    unsigned int hash = hashAttachmentKey(skin, slotIndex, name);
+    _spAttachmentKey *key;
+    int slot;
+    int byteCount;
+    
+    if ((index->count + 1) * 2 > index->capacity) {
+        growAttachmentIndex(index);
+    }
+    
+    slot = hash & (index->capacity - 1);
+    while ((key = index->keys + slot)->skin) {
+        if (key->hash == hash && key->skin == skin && key->slotIndex == slotIndex && strcmp(key->name, name) == 0) {
+            key->attachment = attachment;
+            return;
+        }
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+    
+    byteCount = (int)strlen(name) + 1;
+    key->hash = hash;
+    key->skin = skin;
+    key->slotIndex = slotIndex;
+    key->name = (const char *)memcpy(allocString(&index->names, byteCount), name, byteCount);
+    key->attachment = attachment;
+    index->count++;
+}
+
+static spAttachment *findAttachment(const _spAttachmentIndex *index, const spSkin *skin, int slotIndex, const char *name)
+{
+    unsigned int hash;
+    int slot;
+    
+    if (index->count == 0 || skin == NULL) {
+        return NULL;
+    }
+    
+    hash = hashAttachmentKey(skin, slotIndex, name);
+    for (slot = hash & (index->capacity - 1); index->keys[slot].skin; slot = (slot + 1) & (index->capacity - 1)) {
+        const _spAttachmentKey *key = index->keys + slot;
+        if (key->hash == hash && key->skin == skin && key->slotIndex == slotIndex && strcmp(key->name, name) == 0) {
+            return key->attachment;
+        }
+    }
+    
+    return NULL;
+}
+
+static void freeAttachmentIndex(_spAttachmentIndex *index)
+{
+    free(index->keys);
+    freeStringBuffers(&index->names);
+    index->count = 0;
+    index->capacity = 0;
+    index->keys = NULL;
+}
+
 static spSkin *readSkin(spSkeletonBinary *self, const char *skinName)
 {
     spSkin *skin;
@@ -391,68 +1502,372 @@ static spSkin *readSkin(spSkeletonBinary *self, const char *skinName)
         int slotIndex = readVarint(self, true);
         int nn = readVarint(self, true);
         for (int ii = 0; ii < nn; ii++) {
-            char *name = readString(self);
+            const char *name = readString(self);
             spAttachment *attachment = readAttachment(self, skin, slotIndex, name);
             spSkin_addAttachment(skin, slotIndex, name, attachment);
+            indexAttachment(&self->attachments, skin, slotIndex, name, attachment);
         }
     }
     
     return skin;
 }
 
-static void readCurve(spSkeletonBinary *self, spCurveTimeline *timeline, int frameIndex)
+typedef struct {
+    int count;
+    int capacity;
+    const char **paths;
+} _spRegionPaths;
+
+static void addRegionPath(_spRegionPaths *regions, const char *path)
 {
-    switch (readByte(self)) {
-        case CURVE_STEPPED: {
-            spCurveTimeline_setStepped(timeline, frameIndex);
-            break;
-        }
-        case CURVE_BEZIER: {
-            float v1 = readFloat(self);
-            float v2 = readFloat(self);
-            float v3 = readFloat(self);
-            float v4 = readFloat(self);
-            spCurveTimeline_setCurve(timeline, frameIndex, v1, v2, v3, v4);
-            break;
+    if (regions->count == regions->capacity) {
+        regions->capacity = MAX(regions->capacity * 2, 64);
+        regions->paths = (const char **)realloc(regions->paths, sizeof(const char *) * regions->capacity);
+    }
+    regions->paths[regions->count++] = path;
+}
+
+static int compareRegionPath(const void *a, const void *b)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+// sorts the paths and drops duplicates, returns how many are left
+static int sortRegionPaths(_spRegionPaths *regions)
+{
+    int count = 0;
+    
+    if (regions->count == 0) {
+        return 0;
+    }
+    qsort(regions->paths, regions->count, sizeof(const char *), compareRegionPath);
+    for (int i = 0; i < regions->count; i++) {
+        if (count == 0 || strcmp(regions->paths[i], regions->paths[count - 1]) != 0) {
+            regions->paths[count++] = regions->paths[i];
         }
     }
+    regions->count = count;
+    
+    return count;
 }
 
-static void addAnimationTimeline(_spTimelineArray *arr, spTimeline *timeline)
+static void skipVertices(spSkeletonBinary *self, int vertexCount)
 {
-    if (arr->capacity == 0 || arr->capacity == arr->count) {
-        arr->capacity = arr->capacity == 0 ? 32 : arr->capacity * 2;
-        arr->timelines = (spTimeline **)realloc(arr->timelines, arr->capacity * sizeof(spTimeline *));
+    if (!readBoolean(self)) {
+        skipFloatArray(self, vertexCount << 1);
+    } else {
+        for (int i = 0; i < vertexCount; i++) {
+            for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+                readVarint(self, true);
+                skipBytes(self, sizeof(float) * 3);
+            }
+        }
     }
-    arr->timelines[arr->count++] = timeline;
 }
 
-static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
+// walks an attachment without creating it, mirrors readAttachment. returns
+// the atlas region it references, NULL when it doesn't use one
+static const char *skipAttachment(spSkeletonBinary *self, const char *attachmentName)
 {
-    float scale = self->scale;
-    float duration = 0;
-    int drawOrderCount;
-    int eventCount;
+    const char *path = NULL;
+    const char *name = readString(self);
+    int vertexCount;
     
-    spAnimation *animation;
-    _spTimelineArray arr;
-    arr.timelines = NULL;
-    arr.capacity = 0;
-    arr.count = 0;
+    if (name == NULL) name = attachmentName;
     
-    // slot timelines
-    for (int i = 0, n = readVarint(self, true); i < n; i++) {
-        int slotIndex = readVarint(self, true);
-        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
-            int timelineType = readByte(self);
-            int frameCount = readVarint(self, true);
-            switch (timelineType) {
-                case SLOT_COLOR: {
-                    spColorTimeline *timeline = spColorTimeline_create(frameCount);
-                    timeline->slotIndex = slotIndex;
-                    for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-                        float time = readFloat(self);
-                        float r, g, b, a;
+    switch ((spAttachmentType)readByte(self)) {
+        case SP_ATTACHMENT_REGION:
+            path = readString(self);
+            skipBytes(self, sizeof(float) * 7 + 4);
+            break;
+        case SP_ATTACHMENT_BOUNDING_BOX:
+            skipVertices(self, readVarint(self, true));
+            return NULL;
+        case SP_ATTACHMENT_MESH:
+            path = readString(self);
+            skipBytes(self, 4);
+            vertexCount = readVarint(self, true);
+            skipFloatArray(self, vertexCount << 1);
+            skipShortArray(self, readVarint(self, true));
+            skipVertices(self, vertexCount);
+            readVarint(self, true);
+            break;
+        case SP_ATTACHMENT_LINKED_MESH:
+            path = readString(self);
+            skipBytes(self, 4);
+            skipString(self);
+            skipString(self);
+            readBoolean(self);
+            break;
+        case SP_ATTACHMENT_PATH:
+            readBoolean(self);
+            readBoolean(self);
+            vertexCount = readVarint(self, true);
+            skipVertices(self, vertexCount);
+            skipFloatArray(self, vertexCount / 3);
+            return NULL;
+        default:
+            return NULL;
+    }
+    
+    return path ? path : name;
+}
+
+// returns the number of attachments in the skin, regions may be NULL
+static int skipSkin(spSkeletonBinary *self, _spRegionPaths *regions)
+{
+    int attachmentCount = 0;
+    
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        readVarint(self, true);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            const char *path = skipAttachment(self, readString(self));
+            if (path && regions) {
+                addRegionPath(regions, path);
+            }
+            attachmentCount++;
+        }
+    }
+    
+    return attachmentCount;
+}
+
+// walks over bones, slots and constraints to the default skin
+static void skipToDefaultSkin(spSkeletonBinary *self)
+{
+    // bones
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        skipString(self);
+        if (i > 0) {
+            readVarint(self, true);
+        }
+        skipBytes(self, sizeof(float) * 8 + 2);
+    }
+    
+    // slots
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        skipString(self);
+        readVarint(self, true);
+        skipBytes(self, 4);
+        skipString(self);
+        readByte(self);
+    }
+    
+    // ik constraints
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        skipString(self);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            readVarint(self, true);
+        }
+        readVarint(self, true);
+        skipBytes(self, sizeof(float) + 1);
+    }
+    
+    // transform constraints
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        skipString(self);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            readVarint(self, true);
+        }
+        readVarint(self, true);
+        skipBytes(self, sizeof(float) * 10);
+    }
+    
+    // path constraints
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        skipString(self);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            readVarint(self, true);
+        }
+        readVarint(self, true);
+        readVarint(self, true);
+        readVarint(self, true);
+        readVarint(self, true);
+        skipBytes(self, sizeof(float) * 5);
+    }
+}
+
+// hands the regions of every skin to the prefetch callback ahead of the
+// decode and puts the cursor back where it was
+static void prefetchRegions(spSkeletonBinary *self)
+{
+    _spRegionPaths regions = {0, 0, NULL};
+    int position = self->data->position;
+    
+    if (self->toc) {
+        self->data->position = self->toc->sections[SECTION_DEFAULT_SKIN];
+    } else {
+        skipToDefaultSkin(self);
+    }
+    skipSkin(self, &regions);
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        skipString(self);
+        skipSkin(self, &regions);
+    }
+    
+    self->options->prefetch(self->options->userData, regions.paths, sortRegionPaths(&regions));
+    free(regions.paths);
+    self->data->position = position;
+}
+
+// an animation written with ticks starts with its tick rate, 0 when its
+// keyframes are off any grid and the times are plain floats
+static inline void readTickRate(spSkeletonBinary *self, _spKeyTimes *times)
+{
+    times->rate = self->ticks ? readVarint(self, true) : 0;
+    times->tick = 0;
+}
+
+// each timeline counts its ticks from 0, frames store the delta to the previous one
+static inline float readTime(spSkeletonBinary *self, _spKeyTimes *times, int frameIndex)
+{
+    if (times->rate == 0) {
+        return readFloat(self);
+    }
+    if (frameIndex == 0) {
+        times->tick = 0;
+    }
+    times->tick += readVarint(self, true);
+    return (float)times->tick / times->rate;
+}
+
+// a quantized timeline starts with the range its values are fractions of
+static inline void readQuantizer(spSkeletonBinary *self, _spQuantizer *quantizer)
+{
+    if (self->quantizeBits) {
+        float min = readFloat(self);
+        float max = readFloat(self);
+        quantizer->min = min;
+        quantizer->step = (max - min) / (float)((1 << self->quantizeBits) - 1);
+    }
+}
+
+static inline float readValue(spSkeletonBinary *self, const _spQuantizer *quantizer)
+{
+    switch (self->quantizeBits) {
+        case 8:
+            return quantizer->min + READ() * quantizer->step;
+        case 16:
+            return quantizer->min + (unsigned short)readShort(self) * quantizer->step;
+        default:
+            return readFloat(self);
+    }
+}
+
+static void readValues(spSkeletonBinary *self, const _spQuantizer *quantizer, float *arr, int length, float scale)
+{
+    if (self->quantizeBits == 0) {
+        readFloatArray(self, arr, length, scale);
+        return;
+    }
+    for (int i = 0; i < length; i++) {
+        arr[i] = readValue(self, quantizer) * scale;
+    }
+}
+
+static inline void skipQuantizer(spSkeletonBinary *self)
+{
+    if (self->quantizeBits) {
+        skipBytes(self, sizeof(float) * 2);
+    }
+}
+
+static inline void skipValues(spSkeletonBinary *self, int count)
+{
+    if (self->quantizeBits) {
+        skipBytes(self, count * (self->quantizeBits >> 3));
+    } else {
+        skipBytes(self, sizeof(float) * count);
+    }
+}
+
+static void readCurve(spSkeletonBinary *self, spCurveTimeline *timeline, int frameIndex)
+{
+    switch (readByte(self)) {
+        case CURVE_STEPPED: {
+            spCurveTimeline_setStepped(timeline, frameIndex);
+            break;
+        }
+        case CURVE_BEZIER: {
+            float v1 = readFloat(self);
+            float v2 = readFloat(self);
+            float v3 = readFloat(self);
+            float v4 = readFloat(self);
+            spCurveTimeline_setCurve(timeline, frameIndex, v1, v2, v3, v4);
+            break;
+        }
+    }
+}
+
+static inline void skipCurve(spSkeletonBinary *self, int frameIndex, int frameCount)
+{
+    if (frameIndex < frameCount - 1 && readByte(self) == CURVE_BEZIER) {
+        skipBytes(self, sizeof(float) * 4);
+    }
+}
+
+// walks the frames of a deform timeline past its name, returns its last key time
+static float skipDeformFrames(spSkeletonBinary *self, _spKeyTimes *times)
+{
+    float duration = 0;
+    int frameCount = readVarint(self, true);
+    
+    skipQuantizer(self);
+    for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+        float time = readTime(self, times, frameIndex);
+        int end = readVarint(self, true);
+        if (end != 0) {
+            readVarint(self, true);
+            if (self->quantizeBits) {
+                skipValues(self, end);
+            } else {
+                skipFloatArray(self, end);
+            }
+        }
+        skipCurve(self, frameIndex, frameCount);
+        duration = MAX(duration, time);
+    }
+    
+    return duration;
+}
+
+static void addAnimationTimeline(_spTimelineArray *arr, spTimeline *timeline)
+{
+    if (arr->capacity == 0 || arr->capacity == arr->count) {
+        arr->capacity = arr->capacity == 0 ? 32 : arr->capacity * 2;
+        arr->timelines = (spTimeline **)realloc(arr->timelines, arr->capacity * sizeof(spTimeline *));
+    }
+    arr->timelines[arr->count++] = timeline;
+}
+
+static void readAnimationTimelines(spSkeletonBinary *self, spAnimation *animation)
+{
+    float scale = self->scale;
+    float duration = 0;
+    int drawOrderCount;
+    int eventCount;
+    _spKeyTimes times;
+    
+    _spTimelineArray arr;
+    arr.timelines = NULL;
+    arr.capacity = 0;
+    arr.count = 0;
+    
+    readTickRate(self, &times);
+    
+    // slot timelines
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        int slotIndex = readVarint(self, true);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            int timelineType = readByte(self);
+            int frameCount = readVarint(self, true);
+            switch (timelineType) {
+                case SLOT_COLOR: {
+                    spColorTimeline *timeline = spColorTimeline_create(frameCount);
+                    timeline->slotIndex = slotIndex;
+                    for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+                        float time = readTime(self, &times, frameIndex);
+                        float r, g, b, a;
                         readColor(self, &r, &g, &b, &a);
                         spColorTimeline_setFrame(timeline, frameIndex, time, r, g, b, a);
                         if (frameIndex < frameCount - 1) {
@@ -467,9 +1882,10 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
                     spAttachmentTimeline *timeline = spAttachmentTimeline_create(frameCount);
                     timeline->slotIndex = slotIndex;
                     for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-                        float time = readFloat(self);
-                        char *name = readString(self);
-                        spAttachmentTimeline_setFrame(timeline, frameIndex, time, name);
+                        float time = readTime(self, &times, frameIndex);
+                        // same as spAttachmentTimeline_setFrame, minus the copy
+                        timeline->frames[frameIndex] = time;
+                        timeline->attachmentNames[frameIndex] = internString(self, readString(self));
                     }
                     duration = MAX(duration, timeline->frames[frameCount - 1]);
                     addAnimationTimeline(&arr, SUPER_CAST(spTimeline, timeline));
@@ -488,10 +1904,12 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
             switch (timelineType) {
                 case BONE_ROTATE: {
                     spRotateTimeline *timeline = spRotateTimeline_create(frameCount);
+                    _spQuantizer quantizer;
                     timeline->boneIndex = boneIndex;
+                    readQuantizer(self, &quantizer);
                     for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-                        float time = readFloat(self);
-                        float angle = readFloat(self);
+                        float time = readTime(self, &times, frameIndex);
+                        float angle = readValue(self, &quantizer);
                         spRotateTimeline_setFrame(timeline, frameIndex, time, angle);
                         if (frameIndex < frameCount - 1) {
                             readCurve(self, SUPER(timeline), frameIndex);
@@ -506,6 +1924,7 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
                 case BONE_SCALE:
                 case BONE_SHEAR: {
                     spTranslateTimeline *timeline;
+                    _spQuantizer quantizer;
                     float timelineScale = 1;
                     if (timelineType == BONE_SCALE) {
                         timeline = spScaleTimeline_create(frameCount);
@@ -517,10 +1936,11 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
                         timelineScale = scale;
                     }
                     timeline->boneIndex = boneIndex;
+                    readQuantizer(self, &quantizer);
                     for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-                        float time = readFloat(self);
-                        float x = readFloat(self) * timelineScale;
-                        float y = readFloat(self) * timelineScale;
+                        float time = readTime(self, &times, frameIndex);
+                        float x = readValue(self, &quantizer) * timelineScale;
+                        float y = readValue(self, &quantizer) * timelineScale;
                         spTranslateTimeline_setFrame(timeline, frameIndex, time, x, y);
                         if (frameIndex < frameCount - 1) {
                             readCurve(self, SUPER(timeline), frameIndex);
@@ -540,10 +1960,12 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
         int index = readVarint(self, true);
         int frameCount = readVarint(self, true);
         spIkConstraintTimeline *timeline = spIkConstraintTimeline_create(frameCount);
+        _spQuantizer quantizer;
         timeline->ikConstraintIndex = index;
+        readQuantizer(self, &quantizer);
         for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-            float time = readFloat(self);
-            float mix = readFloat(self);
+            float time = readTime(self, &times, frameIndex);
+            float mix = readValue(self, &quantizer);
             int blendPositive = readByte(self);
             spIkConstraintTimeline_setFrame(timeline, frameIndex, time, mix, blendPositive);
             if (frameIndex < frameCount - 1) {
@@ -559,13 +1981,15 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
         int index = readVarint(self, true);
         int frameCount = readVarint(self, true);
         spTransformConstraintTimeline *timeline = spTransformConstraintTimeline_create(frameCount);
+        _spQuantizer quantizer;
         timeline->transformConstraintIndex = index;
+        readQuantizer(self, &quantizer);
         for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-            float time = readFloat(self);
-            float rotateMix = readFloat(self);
-            float translateMix = readFloat(self);
-            float scaleMix = readFloat(self);
-            float shearMix = readFloat(self);
+            float time = readTime(self, &times, frameIndex);
+            float rotateMix = readValue(self, &quantizer);
+            float translateMix = readValue(self, &quantizer);
+            float scaleMix = readValue(self, &quantizer);
+            float shearMix = readValue(self, &quantizer);
             spTransformConstraintTimeline_setFrame(timeline, frameIndex, time, rotateMix, translateMix, scaleMix, shearMix);
             if (frameIndex < frameCount - 1) {
                 readCurve(self, SUPER(timeline), frameIndex);
@@ -587,6 +2011,7 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
                 case PATH_POSITION:
                 case PATH_SPACING: {
                     spPathConstraintPositionTimeline *timeline;
+                    _spQuantizer quantizer;
                     float timelineScale = 1;
                     if (timelineType == PATH_SPACING) {
                         timeline = (spPathConstraintPositionTimeline *)spPathConstraintSpacingTimeline_create(frameCount);
@@ -600,9 +2025,10 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
                         }
                     }
                     timeline->pathConstraintIndex = index;
+                    readQuantizer(self, &quantizer);
                     for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-                        float time = readFloat(self);
-                        float value = readFloat(self);
+                        float time = readTime(self, &times, frameIndex);
+                        float value = readValue(self, &quantizer);
                         spPathConstraintPositionTimeline_setFrame(timeline, frameIndex, time, value);
                         if (frameIndex < frameCount - 1) {
                             readCurve(self, SUPER(timeline), frameIndex);
@@ -614,11 +2040,13 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
                 }
                 case PATH_MIX: {
                     spPathConstraintMixTimeline *timeline = spPathConstraintMixTimeline_create(frameCount);
+                    _spQuantizer quantizer;
                     timeline->pathConstraintIndex = index;
+                    readQuantizer(self, &quantizer);
                     for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-                        float time = readFloat(self);
-                        float rotateMix = readFloat(self);
-                        float translateMix = readFloat(self);
+                        float time = readTime(self, &times, frameIndex);
+                        float rotateMix = readValue(self, &quantizer);
+                        float translateMix = readValue(self, &quantizer);
                         spPathConstraintMixTimeline_setFrame(timeline, frameIndex, time, rotateMix, translateMix);
                         if (frameIndex < frameCount - 1) {
                             readCurve(self, SUPER(timeline), frameIndex);
@@ -634,12 +2062,20 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
     
     // deform timelines
     for (int i = 0, n = readVarint(self, true); i < n; i++) {
-        spSkin *skin = self->skeletonData->skins[readVarint(self, true)];
+        int skinIndex = readVarint(self, true);
+        spSkin *skin = self->skins ? self->skins[skinIndex] : self->skeletonData->skins[skinIndex];
         for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
             int slotIndex = readVarint(self, true);
             for (int iii = 0, nnn = readVarint(self, true); iii < nnn; iii++) {
-                char *name = readString(self);
-                spVertexAttachment *attachment = SUB_CAST(spVertexAttachment, spSkin_getAttachment(skin, slotIndex, name));
+                const char *name = readString(self);
+                
+                // the skin was left out by the load options
+                if (skin == NULL) {
+                    duration = MAX(duration, skipDeformFrames(self, &times));
+                    continue;
+                }
+                
+                spVertexAttachment *attachment = SUB_CAST(spVertexAttachment, findAttachment(&self->attachments, skin, slotIndex, name));
                 bool weighted = attachment->bones != NULL;
                 float *vertices = attachment->vertices;
                 int deformLength = weighted ? attachment->verticesCount / 3 * 2 : attachment->verticesCount;
@@ -647,32 +2083,40 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
                 int frameCount = readVarint(self, true);
                 
                 spDeformTimeline *timeline = spDeformTimeline_create(frameCount, deformLength);
+                _spQuantizer quantizer;
                 timeline->slotIndex = slotIndex;
                 timeline->attachment = SUPER(attachment);
+                readQuantizer(self, &quantizer);
                 
+                if (deformLength >= self->deformCapacity) {
+                    self->deformCapacity = MAX(self->deformCapacity * 2, MAX(deformLength + 1, 256));
+                    self->deform = (float *)realloc(self->deform, sizeof(float) * self->deformCapacity);
+                }
+                
+                // frames are decoded in scratch and stored once per content by
+                // shareFrame, not copied again by spDeformTimeline_setFrame
+                if (!_boundArena) {
+                    countDeformFrames(timeline);
+                }
                 for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-                    float time = readFloat(self);
-                    float *deform;
+                    float time = readTime(self, &times, frameIndex);
+                    float *deform = self->deform;
                     int end = readVarint(self, true);
-                    if (end == 0)
-                        deform = weighted ? CALLOC(float, deformLength) : vertices;
+                    if (end == 0 && !weighted)
+                        memcpy(deform, vertices, sizeof(float) * deformLength);
                     else {
-                        deform = CALLOC(float, deformLength);
-                        int start = readVarint(self, true);
-                        end += start;
-                        if (scale == 1) {
-                            for (int v = start; v < end; v++)
-                                deform[v] = readFloat(self);
-                        } else {
-                            for (int v = start; v < end; v++)
-                                deform[v] = readFloat(self) * scale;
-                        }
-                        if (!weighted) {
-                            for (int v = 0, vn = deformLength; v < vn; v++)
-                                deform[v] += vertices[v];
+                        memset(deform, 0, sizeof(float) * deformLength);
+                        if (end != 0) {
+                            int start = readVarint(self, true);
+                            readValues(self, &quantizer, deform + start, end, scale);
+                            if (!weighted) {
+                                for (int v = 0, vn = deformLength; v < vn; v++)
+                                    deform[v] += vertices[v];
+                            }
                         }
                     }
-                    spDeformTimeline_setFrame(timeline, frameIndex, time, deform);
+                    timeline->frameVertices[frameIndex] = shareFrame(self, deform, deformLength);
+                    timeline->frames[frameIndex] = time;
                     if (frameIndex < frameCount - 1) {
                         readCurve(self, SUPER(timeline), frameIndex);
                     }
@@ -690,7 +2134,7 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
         int slotCount = self->skeletonData->slotsCount;
         spDrawOrderTimeline *timeline = spDrawOrderTimeline_create(frameCount, slotCount);
         for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-            float time = readFloat(self);
+            float time = readTime(self, &times, frameIndex);
             int offsetCount = readVarint(self, true);
             int *drawOrder = CALLOC(int, slotCount);
             for (int ii = slotCount - 1; ii >= 0; ii--) {
@@ -733,225 +2177,671 @@ static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
         int frameCount = eventCount;
         spEventTimeline *timeline = spEventTimeline_create(frameCount);
         for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
-            float time = readFloat(self);
+            float time = readTime(self, &times, frameIndex);
             spEventData *eventData = self->skeletonData->events[readVarint(self, true)];
             spEvent *event = spEvent_create(time, eventData);
             event->intValue = readVarint(self, false);
             event->floatValue = readFloat(self);
-            event->stringValue = copyString(readBoolean(self) ? readString(self) : eventData->stringValue);
+            event->stringValue = internString(self, readBoolean(self) ? readString(self) : eventData->stringValue);
             spEventTimeline_setFrame(timeline, frameIndex, event);
         }
         duration = MAX(duration, timeline->frames[frameCount - 1]);
         addAnimationTimeline(&arr, SUPER_CAST(spTimeline, timeline));
     }
     
-    animation = spAnimation_create(name, 0);
+    // spAnimation_dispose releases timelines through FREE, so hand it
+    // memory from the spine allocator (and from the arena when one is bound)
     FREE(animation->timelines);
     animation->timelinesCount = arr.count;
-    animation->timelines = arr.timelines;
+    animation->timelines = MALLOC(spTimeline *, arr.count);
+    if (arr.count > 0) {
+        memcpy(animation->timelines, arr.timelines, sizeof(spTimeline *) * arr.count);
+    }
+    free(arr.timelines);
     animation->duration = duration;
-    
+}
+
+static spAnimation *readAnimation(spSkeletonBinary *self, const char *name)
+{
+    spAnimation *animation = spAnimation_create(name, 0);
+    readAnimationTimelines(self, animation);
     return animation;
 }
 
-static void readSkeleton(spSkeletonBinary *self)
+// walks an animation without decoding it, mirrors readAnimationTimelines
+static float skipAnimation(spSkeletonBinary *self)
 {
-    int length;
-    float scale = self->scale;
-    spSkeletonData* skeletonData = self->skeletonData;
+    float duration = 0;
+    _spKeyTimes times;
     
-    // header
-    skeletonData->hash = copyString(readString(self));
-    skeletonData->version = copyString(readString(self));
-    skeletonData->width = readFloat(self);
-    skeletonData->height = readFloat(self);
-    readBoolean(self); // nonessential flag
+    readTickRate(self, &times);
     
-    // bones
-    length = readVarint(self, true);
-    skeletonData->bones = MALLOC(spBoneData*, length);
-    skeletonData->bonesCount = 0;
-    for (int i = 0; i < length; i++) {
-        char *name = readString(self);
-        
-        spBoneData *parent = i == 0 ? NULL : skeletonData->bones[readVarint(self, true)];
-        spBoneData *data = spBoneData_create(i, name, parent);
-        data->rotation = readFloat(self);
-        data->x = readFloat(self) * scale;
-        data->y = readFloat(self) * scale;
-        data->scaleX = readFloat(self);
-        data->scaleY = readFloat(self);
-        data->shearX = readFloat(self);
-        data->shearY = readFloat(self);
-        data->length = readFloat(self) * scale;
-        data->inheritRotation = readBoolean(self);
-        data->inheritScale = readBoolean(self);
-        skeletonData->bones[skeletonData->bonesCount++] = data;
+    // slot timelines
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        readVarint(self, true);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            int timelineType = readByte(self);
+            int frameCount = readVarint(self, true);
+            for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+                float time = readTime(self, &times, frameIndex);
+                if (timelineType == SLOT_COLOR) {
+                    skipBytes(self, 4);
+                    skipCurve(self, frameIndex, frameCount);
+                } else {
+                    skipString(self);
+                }
+                duration = MAX(duration, time);
+            }
+        }
     }
     
-    // slots
-    length = readVarint(self, true);
-    skeletonData->slots = MALLOC(spSlotData *, length);
-    skeletonData->slotsCount = 0;
-    for (int i = 0; i < length; i++) {
-        char *attachment;
-        char *name = readString(self);
-        
-        spBoneData *boneData = skeletonData->bones[readVarint(self, true)];
-        spSlotData *data = spSlotData_create(i, name, boneData);
-        readColor(self, &data->r, &data->g, &data->b, &data->a);
-        attachment = readString(self);
-        spSlotData_setAttachmentName(data, attachment);
-        data->blendMode = (spBlendMode)readByte(self);
-        skeletonData->slots[skeletonData->slotsCount++] = data;
+    // bone timelines
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        readVarint(self, true);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            int valueCount = readByte(self) == BONE_ROTATE ? 1 : 2;
+            int frameCount = readVarint(self, true);
+            skipQuantizer(self);
+            for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+                float time = readTime(self, &times, frameIndex);
+                skipValues(self, valueCount);
+                skipCurve(self, frameIndex, frameCount);
+                duration = MAX(duration, time);
+            }
+        }
     }
     
-    // ik constraints
-    length = readVarint(self, true);
-    skeletonData->ikConstraints = MALLOC(spIkConstraintData *, length);
-    skeletonData->ikConstraintsCount = 0;
-    for (int i = 0; i < length; i++) {
-        char *name = readString(self);
-        
-        spIkConstraintData *data = spIkConstraintData_create(name);
-        int boneCount = readVarint(self, true);
-        data->bones = MALLOC(spBoneData *, boneCount);
-        data->bonesCount = 0;
-        for (int ii = 0; ii < boneCount; ii++) {
-            data->bones[data->bonesCount++] = skeletonData->bones[readVarint(self, true)];
+    // ik constraint timelines
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        int frameCount;
+        readVarint(self, true);
+        frameCount = readVarint(self, true);
+        skipQuantizer(self);
+        for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+            float time = readTime(self, &times, frameIndex);
+            skipValues(self, 1);
+            readByte(self);
+            skipCurve(self, frameIndex, frameCount);
+            duration = MAX(duration, time);
         }
-        data->target = skeletonData->bones[readVarint(self, true)];
-        data->mix = readFloat(self);
-        data->bendDirection = readByte(self);
-        skeletonData->ikConstraints[skeletonData->ikConstraintsCount++] = data;
     }
     
-    // transform constraints
-    length = readVarint(self, true);
-    skeletonData->transformConstraints = MALLOC(spTransformConstraintData *, length);
-    skeletonData->transformConstraintsCount = 0;
-    for (int i = 0; i < length; i++) {
-        int boneCount;
-        char *name = readString(self);
-        
-        spTransformConstraintData *data = spTransformConstraintData_create(name);
-        boneCount = readVarint(self, true);
-        CONST_CAST(spBoneData**, data->bones) = MALLOC(spBoneData*, boneCount);
-        data->bonesCount = 0;
-        for (int ii = 0; ii < boneCount; ii++) {
-            data->bones[data->bonesCount++] = skeletonData->bones[readVarint(self, true)];
-        }
-        data->target = skeletonData->bones[readVarint(self, true)];
-        data->offsetRotation = readFloat(self);
-        data->offsetX = readFloat(self) * scale;
-        data->offsetY = readFloat(self) * scale;
-        data->offsetScaleX = readFloat(self);
-        data->offsetScaleY = readFloat(self);
-        data->offsetShearY = readFloat(self);
-        data->rotateMix = readFloat(self);
-        data->translateMix = readFloat(self);
-        data->scaleMix = readFloat(self);
-        data->shearMix = readFloat(self);
-        skeletonData->transformConstraints[skeletonData->transformConstraintsCount++] = data;
-    };
+    // transform constraint timelines
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        int frameCount;
+        readVarint(self, true);
+        frameCount = readVarint(self, true);
+        skipQuantizer(self);
+        for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+            float time = readTime(self, &times, frameIndex);
+            skipValues(self, 4);
+            skipCurve(self, frameIndex, frameCount);
+            duration = MAX(duration, time);
+        }
+    }
     
-    // path constraints
-    length = readVarint(self, true);
-    skeletonData->pathConstraints = MALLOC(spPathConstraintData *, length);
-    skeletonData->pathConstraintsCount = 0;
-    for (int i = 0; i < length; i++) {
-        int boneCount;
-        char *name = readString(self);
-        
-        spPathConstraintData *data = spPathConstraintData_create(name);
-        boneCount = readVarint(self, true);
-        CONST_CAST(spBoneData**, data->bones) = MALLOC(spBoneData*, boneCount);
-        data->bonesCount = 0;
-        for (int ii = 0; ii < boneCount; ii++) {
-            data->bones[data->bonesCount++] = skeletonData->bones[readVarint(self, true)];
-        }
-        data->target = skeletonData->slots[readVarint(self, true)];
-        data->positionMode = (spPositionMode)readVarint(self, true);
-        data->spacingMode = (spSpacingMode)readVarint(self, true);
-        data->rotateMode = (spRotateMode)readVarint(self, true);
-        data->offsetRotation = readFloat(self);
-        data->position = readFloat(self);
-        if (data->positionMode == SP_POSITION_MODE_FIXED) {
-            data->position *= scale;
-        }
-        data->spacing = readFloat(self);
-        if (data->spacingMode == SP_SPACING_MODE_LENGTH || data->spacingMode == SP_POSITION_MODE_FIXED) {
-            data->spacing *= scale;
-        }
-        data->rotateMix = readFloat(self);
-        data->translateMix = readFloat(self);
-        skeletonData->pathConstraints[skeletonData->pathConstraintsCount++] = data;
-    }
-    
-    // default skin
-    skeletonData->defaultSkin = readSkin(self, "default");
-    
-    // skins
-    length = readVarint(self, true);
-    skeletonData->skins = MALLOC(spSkin *, skeletonData->defaultSkin == NULL ? length : (length + 1));
-    skeletonData->skinsCount = 0;
-    if (skeletonData->defaultSkin) {
-        skeletonData->skins[skeletonData->skinsCount++] = skeletonData->defaultSkin;
+    // path constraint timelines
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        readVarint(self, true);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            int valueCount = readByte(self) == PATH_MIX ? 2 : 1;
+            int frameCount = readVarint(self, true);
+            skipQuantizer(self);
+            for (int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+                float time = readTime(self, &times, frameIndex);
+                skipValues(self, valueCount);
+                skipCurve(self, frameIndex, frameCount);
+                duration = MAX(duration, time);
+            }
+        }
     }
-    for (int i = 0; i < length; i++) {
-        char *name = readString(self);
-        
-        skeletonData->skins[skeletonData->skinsCount++] = readSkin(self, name);
+    
+    // deform timelines
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        readVarint(self, true);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            readVarint(self, true);
+            for (int iii = 0, nnn = readVarint(self, true); iii < nnn; iii++) {
+                skipString(self);
+                duration = MAX(duration, skipDeformFrames(self, &times));
+            }
+        }
     }
     
-    // Linked meshes
-    for (int i = 0; i < self->linkedMeshCount; i++) {
-        spAttachment* parent;
-        _spLinkedMesh* linkedMesh = self->linkedMeshes + i;
-        spSkin* skin = !linkedMesh->skin ? skeletonData->defaultSkin : spSkeletonData_findSkin(skeletonData, linkedMesh->skin);
-        if (!skin) {
-            printf("skin not found: %s\n", linkedMesh->skin);
-            return;
+    // draw order timeline
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        float time = readTime(self, &times, i);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            readVarint(self, true);
+            readVarint(self, true);
         }
-        parent = spSkin_getAttachment(skin, linkedMesh->slotIndex, linkedMesh->parent);
-        if (!parent) {
-            printf("Parent mesh not found: %s\n", linkedMesh->parent);
-            return;
+        duration = MAX(duration, time);
+    }
+    
+    // event timeline
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        float time = readTime(self, &times, i);
+        readVarint(self, true);
+        readVarint(self, false);
+        skipBytes(self, sizeof(float));
+        if (readBoolean(self)) {
+            skipString(self);
         }
-        spMeshAttachment_setParentMesh(linkedMesh->mesh, SUB_CAST(spMeshAttachment, parent));
-        spMeshAttachment_updateUVs(linkedMesh->mesh);
-        spAttachmentLoader_configureAttachment(self->attachmentLoader, SUPER(SUPER(linkedMesh->mesh)));
+        duration = MAX(duration, time);
     }
+    
+    return duration;
+}
 
-    // events
-    length = readVarint(self, true);
-    skeletonData->events = MALLOC(spEventData *, length);
-    skeletonData->eventsCount = 0;
-    for (int i = 0; i < length; i++) {
-        char *name = readString(self);
-        
-        spEventData *data = spEventData_create(name);
-        data->intValue = readVarint(self, false);
-        data->floatValue = readFloat(self);
-        data->stringValue = copyString(readString(self));
-        skeletonData->events[skeletonData->eventsCount++] = data;
+static void freeTableOfContents(_spTableOfContents *toc)
+{
+    free(toc->skins);
+    free(toc->animations);
+    free(toc->durations);
+    free(toc);
+}
+
+static void readTableOfContents(spSkeletonBinary *self)
+{
+    _spTableOfContents *toc = (_spTableOfContents *)malloc(sizeof(_spTableOfContents));
+    bool valid = true;
+    
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        toc->sections[i] = readInt(self);
+        valid = valid && toc->sections[i] >= 0 && toc->sections[i] < self->data->capacity;
     }
     
-    // animations
-    length = readVarint(self, true);
-    skeletonData->animations = MALLOC(spAnimation *, length);
-    skeletonData->animationsCount = 0;
-    for (int i = 0; i < length; i++) {
-        char *name = readString(self);
-        
-        spAnimation *data = readAnimation(self, name);
-        skeletonData->animations[skeletonData->animationsCount++] = data;
+    toc->skinsCount = readVarint(self, true);
+    toc->skins = (int *)malloc(sizeof(int) * MAX(toc->skinsCount, 1));
+    for (int i = 0; i < toc->skinsCount; i++) {
+        toc->skins[i] = readInt(self);
+        valid = valid && toc->skins[i] >= 0 && toc->skins[i] < self->data->capacity;
+    }
+    
+    toc->animationsCount = readVarint(self, true);
+    toc->animations = (int *)malloc(sizeof(int) * MAX(toc->animationsCount, 1));
+    toc->durations = (float *)malloc(sizeof(float) * MAX(toc->animationsCount, 1));
+    for (int i = 0; i < toc->animationsCount; i++) {
+        toc->animations[i] = readInt(self);
+        toc->durations[i] = readFloat(self);
+        valid = valid && toc->animations[i] >= 0 && toc->animations[i] < self->data->capacity;
+    }
+    
+    // a stream can't seek, it just reads on past the table
+    if (self->read || !valid) {
+        freeTableOfContents(toc);
+        return;
     }
+    self->toc = toc;
 }
 
-spSkeletonData *spSkeletonBinary_readSkeletonData(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale)
+// a mapped cstrings image loaded into an arena stays mapped until the arena
+// is disposed, so internString can hand out names straight from the file.
+// FREE leaves them alone like any other arena pointer
+static void adoptImage(spSkeletonBinary *self)
+{
+    _spArenaImage *image = (_spArenaImage *)malloc(sizeof(_spArenaImage));
+    image->content = self->image;
+    image->length = self->imageLength;
+    image->next = _boundArena->images;
+    _boundArena->images = image;
+    _boundArena->size += (size_t)image->length;
+    addArenaRange(_boundArena, image->content, (size_t)image->length);
+    self->image = NULL;
+    self->imageAdopted = true;
+}
+
+// a caller that promised with keepContent to keep its buffer around for as
+// long as the arena lives gets names pointing into it too. the arena only
+// records the range so FREE leaves those names alone, it doesn't count or
+// release the caller's memory
+static void borrowContent(spSkeletonBinary *self)
+{
+    addArenaRange(_boundArena, self->data->content, (size_t)self->data->capacity);
+    self->imageAdopted = true;
+}
+
+// the byte after the header size, see FORMAT_*
+static void readFormat(spSkeletonBinary *self)
+{
+    int flags = (unsigned char)readByte(self);
+    
+    self->cstrings = (flags & FORMAT_CSTRINGS) != 0;
+    self->native = (flags & FORMAT_NATIVE) != 0;
+    self->ticks = (flags & FORMAT_TICKS) != 0;
+    if (flags & FORMAT_QUANTIZED) {
+        self->quantizeBits = readByte(self) == 8 ? 8 : 16;
+    }
+    if (flags & FORMAT_TOC) {
+        readTableOfContents(self);
+    }
+    if (self->cstrings && _boundArena) {
+        if (self->image && self->imageMapped) {
+            adoptImage(self);
+        } else if (self->image == NULL && self->read == NULL && self->options && self->options->keepContent) {
+            borrowContent(self);
+        }
+    }
+}
+
+static bool isListed(const char **names, int count, const char *name)
+{
+    if (names == NULL) {
+        return true;
+    }
+    for (int i = 0; i < count; i++) {
+        if (strcmp(names[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// reads the named skins the options list, then the ones linked meshes
+// borrow their parent from, and leaves the rest out. self->skins maps file
+// indices to what was read for the deform timelines
+static void readListedSkins(spSkeletonBinary *self, int length)
+{
+    spSkeletonData *skeletonData = self->skeletonData;
+    const spSkeletonBinaryOptions *options = self->options;
+    bool indexed = self->toc != NULL && self->toc->skinsCount == length;
+    int first = skeletonData->skinsCount;
+    const char **names = (const char **)malloc(sizeof(char *) * MAX(length, 1));
+    int *offsets = (int *)malloc(sizeof(int) * MAX(length, 1));
+    bool *listed = (bool *)malloc(sizeof(bool) * MAX(length, 1));
+    spSkin **skins;
+    int end;
+    
+    self->skins = (spSkin **)malloc(sizeof(spSkin *) * (first + MAX(length, 1)));
+    if (first) {
+        self->skins[0] = skeletonData->defaultSkin;
+    }
+    skins = self->skins + first;
+    
+    for (int i = 0; i < length; i++) {
+        names[i] = readString(self);
+        offsets[i] = self->data->position;
+        listed[i] = isListed(options->skins, options->skinsCount, names[i]);
+        if (listed[i]) {
+            skins[i] = readSkin(self, names[i]);
+        } else {
+            skins[i] = NULL;
+            if (!indexed) {
+                skipSkin(self, NULL);
+            } else if (i + 1 < length) {
+                self->data->position = self->toc->skins[i + 1];
+            } else {
+                self->data->position = self->toc->sections[SECTION_EVENTS];
+            }
+        }
+    }
+    end = self->data->position;
+    
+    // the list grows while parent skins bring in their own linked meshes
+    for (int i = 0; i < self->linkedMeshCount; i++) {
+        const char *skinName = self->linkedMeshes[i].skin;
+        for (int ii = 0; skinName != NULL && ii < length; ii++) {
+            if (!listed[ii] && strcmp(names[ii], skinName) == 0) {
+                self->data->position = offsets[ii];
+                skins[ii] = readSkin(self, names[ii]);
+                listed[ii] = true;
+            }
+        }
+    }
+    self->data->position = end;
+    
+    for (int i = 0; i < length; i++) {
+        if (listed[i]) {
+            skeletonData->skins[skeletonData->skinsCount++] = skins[i];
+        }
+    }
+    
+    free(names);
+    free(offsets);
+    free(listed);
+}
+
+static void readHeader(spSkeletonBinary *self)
+{
+    spSkeletonData* skeletonData = self->skeletonData;
+    
+    // the strings ahead of the format flags are always length prefixed
+    skeletonData->hash = copyString(readString(self));
+    skeletonData->version = copyString(readString(self));
+    skeletonData->width = readFloat(self);
+    skeletonData->height = readFloat(self);
+    readFormat(self);
+    
+    if (self->options && self->options->prefetch) {
+        prefetchRegions(self);
+    }
+}
+
+static void readBone(spSkeletonBinary *self, int i)
+{
+    float scale = self->scale;
+    spSkeletonData* skeletonData = self->skeletonData;
+    const char *name = readString(self);
+    
+    spBoneData *parent = i == 0 ? NULL : skeletonData->bones[readVarint(self, true)];
+    spBoneData *data = spBoneData_create(i, name, parent);
+    data->rotation = readFloat(self);
+    data->x = readFloat(self) * scale;
+    data->y = readFloat(self) * scale;
+    data->scaleX = readFloat(self);
+    data->scaleY = readFloat(self);
+    data->shearX = readFloat(self);
+    data->shearY = readFloat(self);
+    data->length = readFloat(self) * scale;
+    data->inheritRotation = readBoolean(self);
+    data->inheritScale = readBoolean(self);
+    skeletonData->bones[skeletonData->bonesCount++] = data;
+}
+
+static void readSlot(spSkeletonBinary *self, int i)
+{
+    const char *attachment;
+    spSkeletonData* skeletonData = self->skeletonData;
+    const char *name = readString(self);
+    
+    spBoneData *boneData = skeletonData->bones[readVarint(self, true)];
+    spSlotData *data = spSlotData_create(i, name, boneData);
+    readColor(self, &data->r, &data->g, &data->b, &data->a);
+    attachment = readString(self);
+    data->attachmentName = internString(self, attachment);
+    data->blendMode = (spBlendMode)readByte(self);
+    skeletonData->slots[skeletonData->slotsCount++] = data;
+}
+
+static void readIkConstraint(spSkeletonBinary *self)
+{
+    spSkeletonData* skeletonData = self->skeletonData;
+    const char *name = readString(self);
+    
+    spIkConstraintData *data = spIkConstraintData_create(name);
+    int boneCount = readVarint(self, true);
+    data->bones = MALLOC(spBoneData *, boneCount);
+    data->bonesCount = 0;
+    for (int ii = 0; ii < boneCount; ii++) {
+        data->bones[data->bonesCount++] = skeletonData->bones[readVarint(self, true)];
+    }
+    data->target = skeletonData->bones[readVarint(self, true)];
+    data->mix = readFloat(self);
+    data->bendDirection = readByte(self);
+    skeletonData->ikConstraints[skeletonData->ikConstraintsCount++] = data;
+}
+
+static void readTransformConstraint(spSkeletonBinary *self)
+{
+    int boneCount;
+    float scale = self->scale;
+    spSkeletonData* skeletonData = self->skeletonData;
+    const char *name = readString(self);
+    
+    spTransformConstraintData *data = spTransformConstraintData_create(name);
+    boneCount = readVarint(self, true);
+    CONST_CAST(spBoneData**, data->bones) = MALLOC(spBoneData*, boneCount);
+    data->bonesCount = 0;
+    for (int ii = 0; ii < boneCount; ii++) {
+        data->bones[data->bonesCount++] = skeletonData->bones[readVarint(self, true)];
+    }
+    data->target = skeletonData->bones[readVarint(self, true)];
+    data->offsetRotation = readFloat(self);
+    data->offsetX = readFloat(self) * scale;
+    data->offsetY = readFloat(self) * scale;
+    data->offsetScaleX = readFloat(self);
+    data->offsetScaleY = readFloat(self);
+    data->offsetShearY = readFloat(self);
+    data->rotateMix = readFloat(self);
+    data->translateMix = readFloat(self);
+    data->scaleMix = readFloat(self);
+    data->shearMix = readFloat(self);
+    skeletonData->transformConstraints[skeletonData->transformConstraintsCount++] = data;
+}
+
+static void readPathConstraint(spSkeletonBinary *self)
+{
+    int boneCount;
+    float scale = self->scale;
+    spSkeletonData* skeletonData = self->skeletonData;
+    const char *name = readString(self);
+    
+    spPathConstraintData *data = spPathConstraintData_create(name);
+    boneCount = readVarint(self, true);
+    CONST_CAST(spBoneData**, data->bones) = MALLOC(spBoneData*, boneCount);
+    data->bonesCount = 0;
+    for (int ii = 0; ii < boneCount; ii++) {
+        data->bones[data->bonesCount++] = skeletonData->bones[readVarint(self, true)];
+    }
+    data->target = skeletonData->slots[readVarint(self, true)];
+    data->positionMode = (spPositionMode)readVarint(self, true);
+    data->spacingMode = (spSpacingMode)readVarint(self, true);
+    data->rotateMode = (spRotateMode)readVarint(self, true);
+    data->offsetRotation = readFloat(self);
+    data->position = readFloat(self);
+    if (data->positionMode == SP_POSITION_MODE_FIXED) {
+        data->position *= scale;
+    }
+    data->spacing = readFloat(self);
+    if (data->spacingMode == SP_SPACING_MODE_LENGTH || data->spacingMode == SP_POSITION_MODE_FIXED) {
+        data->spacing *= scale;
+    }
+    data->rotateMix = readFloat(self);
+    data->translateMix = readFloat(self);
+    skeletonData->pathConstraints[skeletonData->pathConstraintsCount++] = data;
+}
+
+static bool linkMesh(spSkeletonBinary *self, int i)
+{
+    spAttachment* parent;
+    spSkeletonData* skeletonData = self->skeletonData;
+    _spLinkedMesh* linkedMesh = self->linkedMeshes + i;
+    spSkin* skin = !linkedMesh->skin ? skeletonData->defaultSkin : spSkeletonData_findSkin(skeletonData, linkedMesh->skin);
+    if (!skin) {
+        printf("skin not found: %s\n", linkedMesh->skin);
+        return false;
+    }
+    parent = findAttachment(&self->attachments, skin, linkedMesh->slotIndex, linkedMesh->parent);
+    if (!parent) {
+        printf("Parent mesh not found: %s\n", linkedMesh->parent);
+        return false;
+    }
+    spMeshAttachment_setParentMesh(linkedMesh->mesh, SUB_CAST(spMeshAttachment, parent));
+    spMeshAttachment_updateUVs(linkedMesh->mesh);
+    configureAttachment(self, SUPER(SUPER(linkedMesh->mesh)));
+    return true;
+}
+
+static void readEvent(spSkeletonBinary *self)
+{
+    spSkeletonData* skeletonData = self->skeletonData;
+    const char *name = readString(self);
+    
+    spEventData *data = spEventData_create(name);
+    data->intValue = readVarint(self, false);
+    data->floatValue = readFloat(self);
+    data->stringValue = internString(self, readString(self));
+    skeletonData->events[skeletonData->eventsCount++] = data;
+}
+
+static void readAnimationEntry(spSkeletonBinary *self, int i)
+{
+    int length = self->stageLength;
+    spSkeletonData* skeletonData = self->skeletonData;
+    bool indexed = self->toc != NULL && self->toc->animationsCount == length;
+    const char *name = readString(self);
+    
+    spAnimation *data;
+    if (self->options && !isListed(self->options->animations, self->options->animationsCount, name)) {
+        if (!indexed) {
+            skipAnimation(self);
+        } else if (i + 1 < length) {
+            self->data->position = self->toc->animations[i + 1];
+        }
+        return;
+    } else if (self->lazy) {
+        // only names and durations for now, see decodeAnimation
+        data = spAnimation_create(name, 0);
+        self->animationOffsets[i] = self->data->position;
+        if (indexed) {
+            data->duration = self->toc->durations[i];
+            if (i + 1 < length) {
+                self->data->position = self->toc->animations[i + 1];
+            }
+        } else {
+            data->duration = skipAnimation(self);
+        }
+    } else {
+        data = readAnimation(self, name);
+    }
+    skeletonData->animations[skeletonData->animationsCount++] = data;
+}
+
+// moves on to the given section: reads its item count and allocates its array
+static void beginStage(spSkeletonBinary *self, int stage)
+{
+    int length = 0;
+    spSkeletonData* skeletonData = self->skeletonData;
+    
+    switch (stage) {
+        case STAGE_HEADER:
+        case STAGE_DEFAULT_SKIN:
+            length = 1;
+            break;
+        case STAGE_BONES:
+            length = readVarint(self, true);
+            skeletonData->bones = MALLOC(spBoneData*, length);
+            skeletonData->bonesCount = 0;
+            break;
+        case STAGE_SLOTS:
+            length = readVarint(self, true);
+            skeletonData->slots = MALLOC(spSlotData *, length);
+            skeletonData->slotsCount = 0;
+            break;
+        case STAGE_IK_CONSTRAINTS:
+            length = readVarint(self, true);
+            skeletonData->ikConstraints = MALLOC(spIkConstraintData *, length);
+            skeletonData->ikConstraintsCount = 0;
+            break;
+        case STAGE_TRANSFORM_CONSTRAINTS:
+            length = readVarint(self, true);
+            skeletonData->transformConstraints = MALLOC(spTransformConstraintData *, length);
+            skeletonData->transformConstraintsCount = 0;
+            break;
+        case STAGE_PATH_CONSTRAINTS:
+            length = readVarint(self, true);
+            skeletonData->pathConstraints = MALLOC(spPathConstraintData *, length);
+            skeletonData->pathConstraintsCount = 0;
+            break;
+        case STAGE_SKINS:
+            length = readVarint(self, true);
+            skeletonData->skins = MALLOC(spSkin *, skeletonData->defaultSkin == NULL ? length : (length + 1));
+            skeletonData->skinsCount = 0;
+            if (skeletonData->defaultSkin) {
+                skeletonData->skins[skeletonData->skinsCount++] = skeletonData->defaultSkin;
+            }
+            if (self->options) {
+                // all in one go, it has to come back for the parents of linked meshes
+                readListedSkins(self, length);
+                length = 0;
+            }
+            break;
+        case STAGE_LINKED_MESHES:
+            length = self->linkedMeshCount;
+            break;
+        case STAGE_EVENTS:
+            length = readVarint(self, true);
+            skeletonData->events = MALLOC(spEventData *, length);
+            skeletonData->eventsCount = 0;
+            break;
+        case STAGE_ANIMATIONS:
+            length = readVarint(self, true);
+            skeletonData->animations = MALLOC(spAnimation *, length);
+            skeletonData->animationsCount = 0;
+            if (self->lazy) {
+                self->animationOffsets = (int *)malloc(sizeof(int) * MAX(length, 1));
+            }
+            break;
+        case STAGE_DONE:
+            configureDeferredAttachments(self);
+            break;
+    }
+    
+    self->stage = stage;
+    self->stageIndex = 0;
+    self->stageLength = length;
+}
+
+// reads the next bone, slot, constraint, skin, linked mesh, event or
+// animation, returns false once the skeleton is complete
+static bool readSkeletonItem(spSkeletonBinary *self)
+{
+    int i = self->stageIndex;
+    spSkeletonData* skeletonData = self->skeletonData;
+    
+    if (self->stage == STAGE_DONE) {
+        return false;
+    }
+    if (i == self->stageLength) {
+        beginStage(self, self->stage + 1);
+        return self->stage != STAGE_DONE;
+    }
+    
+    self->stageIndex++;
+    switch (self->stage) {
+        case STAGE_HEADER:
+            readHeader(self);
+            break;
+        case STAGE_BONES:
+            readBone(self, i);
+            break;
+        case STAGE_SLOTS:
+            readSlot(self, i);
+            break;
+        case STAGE_IK_CONSTRAINTS:
+            readIkConstraint(self);
+            break;
+        case STAGE_TRANSFORM_CONSTRAINTS:
+            readTransformConstraint(self);
+            break;
+        case STAGE_PATH_CONSTRAINTS:
+            readPathConstraint(self);
+            break;
+        case STAGE_DEFAULT_SKIN:
+            skeletonData->defaultSkin = readSkin(self, "default");
+            break;
+        case STAGE_SKINS: {
+            const char *name = readString(self);
+            
+            skeletonData->skins[skeletonData->skinsCount++] = readSkin(self, name);
+            break;
+        }
+        case STAGE_LINKED_MESHES:
+            // a mesh that can't be linked ends the load, without events and animations
+            if (!linkMesh(self, i)) {
+                beginStage(self, STAGE_DONE);
+            }
+            break;
+        case STAGE_EVENTS:
+            readEvent(self);
+            break;
+        case STAGE_ANIMATIONS:
+            readAnimationEntry(self, i);
+            break;
+    }
+    
+    return true;
+}
+
+static void readSkeleton(spSkeletonBinary *self)
+{
+    beginStage(self, STAGE_HEADER);
+    while (readSkeletonItem(self)) {
+    }
+}
+
+static spSkeletonBinary *createSkeletonBinary(spAttachmentLoader *attachmentLoader, float scale)
 {
-    spSkeletonData *skeketon;
     spSkeletonBinary *self;
     self = (spSkeletonBinary *)malloc(sizeof(spSkeletonBinary));
     self->scale = scale;
@@ -960,30 +2850,966 @@ spSkeletonData *spSkeletonBinary_readSkeletonData(const char *skeketonPath, spAt
     self->data = (_spStringBuffer *)malloc(sizeof(_spStringBuffer));
     self->data->next = NULL;
     self->data->position = 0;
-    self->data->content = _spUtil_readFile(skeketonPath, &self->data->capacity);
+    self->data->capacity = 0;
+    self->data->content = NULL;
+    
+    self->read = NULL;
+    self->readUserData = NULL;
+    self->windowSize = 0;
+    self->base = 0;
     
     self->buffer = NULL;
+    self->cstrings = false;
+    self->native = false;
+    self->quantizeBits = 0;
+    self->ticks = false;
+    self->toc = NULL;
+    self->options = NULL;
+    self->skins = NULL;
+    
+    self->stage = STAGE_DONE;
+    self->stageIndex = 0;
+    self->stageLength = 0;
+    
+    self->strings.count = 0;
+    self->strings.capacity = 0;
+    self->strings.strings = NULL;
+    
+    self->frames.count = 0;
+    self->frames.capacity = 0;
+    self->frames.frames = NULL;
+    self->sharedFrames = NULL;
+    
+    self->attachments.count = 0;
+    self->attachments.capacity = 0;
+    self->attachments.keys = NULL;
+    self->attachments.names = NULL;
+    
+    self->bones = NULL;
+    self->bonesCapacity = 0;
+    self->weights = NULL;
+    self->weightsCapacity = 0;
+    self->deform = NULL;
+    self->deformCapacity = 0;
     
     self->linkedMeshCount = 0;
     self->linkedMeshCapacity = 0;
     self->linkedMeshes = NULL;
     
-    self->skeletonData = spSkeletonData_create();
-    readSkeleton(self);
-    skeketon = self->skeletonData;
+    self->deferredCount = 0;
+    self->deferredCapacity = 0;
+    self->deferred = NULL;
+    
+    self->lazy = false;
+    self->animationOffsets = NULL;
+    self->names = NULL;
+    self->arena = NULL;
+    
+    self->image = NULL;
+    self->imageLength = 0;
+    self->imageMapped = false;
+    self->imageAdopted = false;
+    
     self->skeletonData = NULL;
     
-    while(self->buffer) {
-        _spStringBuffer *next = self->buffer->next;
-        free(self->buffer->content);
-        free(self->buffer);
-        self->buffer = next;
+    return self;
+}
+
+#ifdef SKELETONBINARY_MMAP
+static char *mapFile(const char *path, int *length)
+{
+    struct stat st;
+    void *content;
+    int fd = open(path, O_RDONLY);
+    
+    if (fd < 0) {
+        return NULL;
+    }
+    
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || st.st_size > INT_MAX) {
+        close(fd);
+        return NULL;
+    }
+    
+    content = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (content == MAP_FAILED) {
+        return NULL;
+    }
+    
+    // the reader walks the file front to back exactly once
+    posix_madvise(content, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    
+    *length = (int)st.st_size;
+    return (char *)content;
+}
+#endif
+
+static char *openImage(const char *path, int *length, bool *mapped)
+{
+    spSkeletonBinaryArena *arena;
+    char *content;
+    
+#ifdef SKELETONBINARY_MMAP
+    // map the file read-only, paths that can't be opened directly
+    // (e.g. packed platform assets) fall back to _spUtil_readFile
+    content = mapFile(path, length);
+    if (content != NULL) {
+        *mapped = true;
+        return content;
+    }
+#endif
+    
+    // the file content is scratch, keep it out of a bound arena
+    arena = spSkeletonBinaryArena_bind(NULL);
+    content = _spUtil_readFile(path, length);
+    spSkeletonBinaryArena_bind(arena);
+    *mapped = false;
+    return content;
+}
+
+static void closeImage(char *content, int length, bool mapped)
+{
+    spSkeletonBinaryArena *arena;
+    
+#ifdef SKELETONBINARY_MMAP
+    if (mapped) {
+        munmap(content, (size_t)length);
+        return;
+    }
+#endif
+    
+    arena = spSkeletonBinaryArena_bind(NULL);
+    FREE(content);
+    spSkeletonBinaryArena_bind(arena);
+}
+
+void spSkeletonBinary_dispose(spSkeletonBinary *self)
+{
+    // a time-sliced load given up before finish, see spSkeletonBinary_begin;
+    // a lazy reader's skeleton data is the caller's
+    if (self->skeletonData && !self->lazy) {
+        // its frees have to find the arena the steps allocated from
+        spSkeletonBinaryArena *arena = spSkeletonBinaryArena_bind(self->arena);
+        
+        // the default skin only joins the skins when their section begins
+        if (self->stage == STAGE_DEFAULT_SKIN && self->skeletonData->defaultSkin) {
+            spSkin_dispose(self->skeletonData->defaultSkin);
+        }
+        spSkeletonData_dispose(self->skeletonData);
+        spSkeletonBinaryArena_bind(arena);
+    }
+    
+    freeStringBuffers(&self->buffer);
+    freeStringTable(&self->strings);
+    freeFrameTable(&self->frames);
+    freeAttachmentIndex(&self->attachments);
+    
+    if (self->read) {
+        free(self->data->content);
+    }
+    
+    if (self->image) {
+        closeImage(self->image, self->imageLength, self->imageMapped);
     }
     
-    free(self->data->content);
     free(self->data);
+    free(self->bones);
+    free(self->weights);
+    free(self->deform);
     free(self->linkedMeshes);
+    free(self->deferred);
+    free(self->animationOffsets);
+    free(self->skins);
+    if (self->names) {
+        spSkeletonBinaryIndex_dispose(self->names);
+    }
+    if (self->toc) {
+        freeTableOfContents(self->toc);
+    }
     free(self);
+}
+
+static spSkeletonData *readSkeletonData(spSkeletonBinary *self)
+{
+    spSkeletonData *skeketon;
+    
+    self->skeletonData = spSkeletonData_create();
+    readSkeleton(self);
+    skeketon = self->skeletonData;
+    self->skeletonData = NULL;
+    spSkeletonBinary_dispose(self);
     
     return skeketon;
 }
+
+static spSkeletonData *readSkeletonDataFromBuffer(const char *content, int length, spAttachmentLoader *attachmentLoader, float scale, const spSkeletonBinaryOptions *options)
+{
+    spSkeletonBinary *self = createSkeletonBinary(attachmentLoader, scale);
+    self->options = options;
+    
+    // the caller owns content, it is only read through READ() unless
+    // keepContent lets borrowContent point names into it
+    self->data->capacity = length;
+    self->data->content = (char *)content;
+    
+    return readSkeletonData(self);
+}
+
+spSkeletonData *spSkeletonBinary_readSkeletonData(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale)
+{
+    return spSkeletonBinary_readSkeletonDataWithOptions(skeketonPath, attachmentLoader, scale, NULL);
+}
+
+spSkeletonData *spSkeletonBinary_readSkeletonDataWithOptions(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale, const spSkeletonBinaryOptions *options)
+{
+    spSkeletonBinary *self;
+    bool mapped;
+    int length;
+    char *content = openImage(skeketonPath, &length, &mapped);
+    
+    if (content == NULL) {
+        return NULL;
+    }
+    
+    // the reader closes the image unless an arena adopts it
+    self = createSkeletonBinary(attachmentLoader, scale);
+    self->options = options;
+    self->image = content;
+    self->imageLength = length;
+    self->imageMapped = mapped;
+    self->data->capacity = length;
+    self->data->content = content;
+    
+    return readSkeletonData(self);
+}
+
+spSkeletonData *spSkeletonBinary_readSkeletonDataFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale)
+{
+    return readSkeletonDataFromBuffer((const char *)content, (int)length, attachmentLoader, scale, NULL);
+}
+
+spSkeletonData *spSkeletonBinary_readSkeletonDataFromMemoryWithOptions(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale, const spSkeletonBinaryOptions *options)
+{
+    return readSkeletonDataFromBuffer((const char *)content, (int)length, attachmentLoader, scale, options);
+}
+
+spSkeletonData *spSkeletonBinary_readSkeletonDataFromStream(spSkeletonBinaryReadFunc read, void *userData, spAttachmentLoader *attachmentLoader, float scale)
+{
+    spSkeletonBinary *self = createSkeletonBinary(attachmentLoader, scale);
+    
+    self->read = read;
+    self->readUserData = userData;
+    self->windowSize = STREAM_WINDOW_SIZE;
+    self->data->content = (char *)malloc(self->windowSize);
+    
+    return readSkeletonData(self);
+}
+
+static spSkeletonBinary *readLazySkeletonData(spSkeletonBinary *self)
+{
+    self->lazy = true;
+    self->arena = spSkeletonBinaryArena_bind(NULL);
+    spSkeletonBinaryArena_bind(self->arena);
+    
+    self->skeletonData = spSkeletonData_create();
+    readSkeleton(self);
+    resetStringBuffers(self);
+    
+    return self;
+}
+
+spSkeletonBinary *spSkeletonBinary_createLazy(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale)
+{
+    spSkeletonBinary *self;
+    bool mapped;
+    int length;
+    char *content = openImage(skeketonPath, &length, &mapped);
+    
+    if (content == NULL) {
+        return NULL;
+    }
+    
+    self = createSkeletonBinary(attachmentLoader, scale);
+    self->image = content;
+    self->imageLength = length;
+    self->imageMapped = mapped;
+    self->data->capacity = length;
+    self->data->content = content;
+    
+    return readLazySkeletonData(self);
+}
+
+spSkeletonBinary *spSkeletonBinary_createLazyFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale)
+{
+    spSkeletonBinary *self = createSkeletonBinary(attachmentLoader, scale);
+    
+    self->data->capacity = (int)length;
+    self->data->content = (char *)content;
+    
+    return readLazySkeletonData(self);
+}
+
+spSkeletonData *spSkeletonBinary_getSkeletonData(spSkeletonBinary *self)
+{
+    return self->skeletonData;
+}
+
+spAnimation *spSkeletonBinary_getAnimation(spSkeletonBinary *self, int index)
+{
+    spAnimation *animation;
+    spSkeletonBinaryArena *arena;
+    
+    if (index < 0 || index >= self->skeletonData->animationsCount) {
+        return NULL;
+    }
+    
+    animation = self->skeletonData->animations[index];
+    if (self->animationOffsets != NULL && self->animationOffsets[index] >= 0) {
+        // decode into the placeholder so pointers handed out before stay valid
+        arena = spSkeletonBinaryArena_bind(self->arena);
+        self->data->position = self->animationOffsets[index];
+        self->animationOffsets[index] = -1;
+        readAnimationTimelines(self, animation);
+        resetStringBuffers(self);
+        spSkeletonBinaryArena_bind(arena);
+    }
+    
+    return animation;
+}
+
+spAnimation *spSkeletonBinary_findAnimation(spSkeletonBinary *self, const char *animationName)
+{
+    // built on first lookup, parallel loads and index based callers never need it
+    if (self->names == NULL) {
+        self->names = spSkeletonBinaryIndex_create(self->skeletonData);
+    }
+    return spSkeletonBinary_getAnimation(self, spSkeletonBinaryIndex_findAnimationIndex(self->names, animationName));
+}
+
+static int64_t getMicroseconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (int64_t)(counter.QuadPart / frequency.QuadPart * 1000000 + counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
+
+static spSkeletonBinary *beginSkeletonData(spSkeletonBinary *self)
+{
+    // every step allocates into the arena bound now, like the lazy reader
+    self->arena = spSkeletonBinaryArena_bind(NULL);
+    spSkeletonBinaryArena_bind(self->arena);
+    
+    self->skeletonData = spSkeletonData_create();
+    beginStage(self, STAGE_HEADER);
+    
+    return self;
+}
+
+spSkeletonBinary *spSkeletonBinary_begin(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale)
+{
+    spSkeletonBinary *self;
+    bool mapped;
+    int length;
+    char *content = openImage(skeketonPath, &length, &mapped);
+    
+    if (content == NULL) {
+        return NULL;
+    }
+    
+    self = createSkeletonBinary(attachmentLoader, scale);
+    self->image = content;
+    self->imageLength = length;
+    self->imageMapped = mapped;
+    self->data->capacity = length;
+    self->data->content = content;
+    
+    return beginSkeletonData(self);
+}
+
+spSkeletonBinary *spSkeletonBinary_beginFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale)
+{
+    spSkeletonBinary *self = createSkeletonBinary(attachmentLoader, scale);
+    
+    self->data->capacity = (int)length;
+    self->data->content = (char *)content;
+    
+    return beginSkeletonData(self);
+}
+
+bool spSkeletonBinary_step(spSkeletonBinary *self, int budget)
+{
+    spSkeletonBinaryArena *arena = spSkeletonBinaryArena_bind(self->arena);
+    int64_t deadline = getMicroseconds() + budget;
+    bool reading;
+    
+    // at least one item per call, so a budget that's too small still gets somewhere
+    do {
+        reading = readSkeletonItem(self);
+    } while (reading && getMicroseconds() < deadline);
+    
+    spSkeletonBinaryArena_bind(arena);
+    
+    return !reading;
+}
+
+spSkeletonData *spSkeletonBinary_finish(spSkeletonBinary *self)
+{
+    spSkeletonData *skeketon;
+    spSkeletonBinaryArena *arena = spSkeletonBinaryArena_bind(self->arena);
+    
+    while (readSkeletonItem(self)) {
+    }
+    spSkeletonBinaryArena_bind(arena);
+    
+    skeketon = self->skeletonData;
+    self->skeletonData = NULL;
+    spSkeletonBinary_dispose(self);
+    
+    return skeketon;
+}
+
+typedef struct {
+    unsigned int hash;
+    int index;
+} _spNameSlot;
+
+// index is -1 in empty slots
+typedef struct {
+    int mask;
+    _spNameSlot *slots;
+} _spNameTable;
+
+struct spSkeletonBinaryIndex {
+    const spSkeletonData *skeletonData;
+    _spNameTable bones;
+    _spNameTable slots;
+    _spNameTable skins;
+    _spNameTable animations;
+};
+
+typedef const char *(*_spNameFunc)(const spSkeletonData *skeletonData, int index);
+
+static const char *getBoneName(const spSkeletonData *skeletonData, int index)
+{
+    return skeletonData->bones[index]->name;
+}
+
+static const char *getSlotName(const spSkeletonData *skeletonData, int index)
+{
+    return skeletonData->slots[index]->name;
+}
+
+static const char *getSkinName(const spSkeletonData *skeletonData, int index)
+{
+    // empty skins are kept as NULL
+    return skeletonData->skins[index] ? skeletonData->skins[index]->name : NULL;
+}
+
+static const char *getAnimationName(const spSkeletonData *skeletonData, int index)
+{
+    return skeletonData->animations[index]->name;
+}
+
+static void buildNameTable(_spNameTable *table, const spSkeletonData *skeletonData, int count, _spNameFunc getName)
+{
+    int capacity = 4;
+    
+    while (capacity < count * 2) {
+        capacity <<= 1;
+    }
+    table->mask = capacity - 1;
+    table->slots = (_spNameSlot *)malloc(sizeof(_spNameSlot) * capacity);
+    for (int i = 0; i < capacity; i++) {
+        table->slots[i].index = -1;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        const char *name = getName(skeletonData, i);
+        size_t length;
+        unsigned int hash;
+        int slot;
+        
+        if (name == NULL) {
+            continue;
+        }
+        
+        hash = hashString(name, &length);
+        for (slot = hash & table->mask; table->slots[slot].index >= 0; slot = (slot + 1) & table->mask) {
+            if (table->slots[slot].hash == hash && strcmp(getName(skeletonData, table->slots[slot].index), name) == 0) {
+                break;
+            }
+        }
+        if (table->slots[slot].index < 0) {
+            table->slots[slot].hash = hash;
+            table->slots[slot].index = i;
+        }
+    }
+}
+
+static int findName(const _spNameTable *table, const spSkeletonData *skeletonData, _spNameFunc getName, const char *name)
+{
+    size_t length;
+    unsigned int hash = hashString(name, &length);
+    
+    for (int slot = hash & table->mask; table->slots[slot].index >= 0; slot = (slot + 1) & table->mask) {
+        if (table->slots[slot].hash == hash && strcmp(getName(skeletonData, table->slots[slot].index), name) == 0) {
+            return table->slots[slot].index;
+        }
+    }
+    
+    return -1;
+}
+
+spSkeletonBinaryIndex *spSkeletonBinaryIndex_create(const spSkeletonData *skeletonData)
+{
+    spSkeletonBinaryIndex *self = (spSkeletonBinaryIndex *)malloc(sizeof(spSkeletonBinaryIndex));
+    self->skeletonData = skeletonData;
+    buildNameTable(&self->bones, skeletonData, skeletonData->bonesCount, getBoneName);
+    buildNameTable(&self->slots, skeletonData, skeletonData->slotsCount, getSlotName);
+    buildNameTable(&self->skins, skeletonData, skeletonData->skinsCount, getSkinName);
+    buildNameTable(&self->animations, skeletonData, skeletonData->animationsCount, getAnimationName);
+    return self;
+}
+
+void spSkeletonBinaryIndex_dispose(spSkeletonBinaryIndex *self)
+{
+    free(self->bones.slots);
+    free(self->slots.slots);
+    free(self->skins.slots);
+    free(self->animations.slots);
+    free(self);
+}
+
+int spSkeletonBinaryIndex_findBoneIndex(const spSkeletonBinaryIndex *self, const char *boneName)
+{
+    return findName(&self->bones, self->skeletonData, getBoneName, boneName);
+}
+
+int spSkeletonBinaryIndex_findSlotIndex(const spSkeletonBinaryIndex *self, const char *slotName)
+{
+    return findName(&self->slots, self->skeletonData, getSlotName, slotName);
+}
+
+int spSkeletonBinaryIndex_findSkinIndex(const spSkeletonBinaryIndex *self, const char *skinName)
+{
+    return findName(&self->skins, self->skeletonData, getSkinName, skinName);
+}
+
+int spSkeletonBinaryIndex_findAnimationIndex(const spSkeletonBinaryIndex *self, const char *animationName)
+{
+    return findName(&self->animations, self->skeletonData, getAnimationName, animationName);
+}
+
+spBoneData *spSkeletonBinaryIndex_findBone(const spSkeletonBinaryIndex *self, const char *boneName)
+{
+    int index = spSkeletonBinaryIndex_findBoneIndex(self, boneName);
+    return index < 0 ? NULL : self->skeletonData->bones[index];
+}
+
+spSlotData *spSkeletonBinaryIndex_findSlot(const spSkeletonBinaryIndex *self, const char *slotName)
+{
+    int index = spSkeletonBinaryIndex_findSlotIndex(self, slotName);
+    return index < 0 ? NULL : self->skeletonData->slots[index];
+}
+
+spSkin *spSkeletonBinaryIndex_findSkin(const spSkeletonBinaryIndex *self, const char *skinName)
+{
+    int index = spSkeletonBinaryIndex_findSkinIndex(self, skinName);
+    return index < 0 ? NULL : self->skeletonData->skins[index];
+}
+
+spAnimation *spSkeletonBinaryIndex_findAnimation(const spSkeletonBinaryIndex *self, const char *animationName)
+{
+    int index = spSkeletonBinaryIndex_findAnimationIndex(self, animationName);
+    return index < 0 ? NULL : self->skeletonData->animations[index];
+}
+
+typedef struct {
+    spSkeletonBinary *binary;
+    int *order;
+    
+    // deform frames of every animation, shared by the workers under _framesLock
+    _spFrameTable frames;
+} _spParallelDecode;
+
+typedef struct {
+    int offset;
+    int length;
+    int index;
+} _spAnimationSpan;
+
+static int compareAnimationSpan(const void *a, const void *b)
+{
+    return ((const _spAnimationSpan *)b)->length - ((const _spAnimationSpan *)a)->length;
+}
+
+static void decodeAnimationTask(void *arg, int index)
+{
+    _spParallelDecode *decode = (_spParallelDecode *)arg;
+    spSkeletonBinary *self = decode->binary;
+    int animationIndex = decode->order[index];
+    spSkeletonBinary worker = *self;
+    _spStringBuffer data = *self->data;
+    spSkeletonBinaryArena *arena = spSkeletonBinaryArena_bind(self->arena);
+    
+    // a private cursor and string buffers over the shared image, everything
+    // else readAnimationTimelines touches is only read
+    data.position = self->animationOffsets[animationIndex];
+    worker.data = &data;
+    worker.buffer = NULL;
+    memset(&worker.strings, 0, sizeof(worker.strings));
+    worker.sharedFrames = &decode->frames;
+    worker.bones = NULL;
+    worker.bonesCapacity = 0;
+    worker.weights = NULL;
+    worker.weightsCapacity = 0;
+    worker.deform = NULL;
+    worker.deformCapacity = 0;
+    readAnimationTimelines(&worker, self->skeletonData->animations[animationIndex]);
+    freeStringBuffers(&worker.buffer);
+    freeStringTable(&worker.strings);
+    free(worker.deform);
+    free(worker.bones);
+    free(worker.weights);
+    
+    spSkeletonBinaryArena_bind(arena);
+}
+
+#ifndef _WIN32
+typedef struct {
+    pthread_mutex_t lock;
+    int next;
+    int count;
+    spSkeletonBinaryTaskFunc task;
+    void *arg;
+} _spTaskQueue;
+
+static void *runTasks(void *arg)
+{
+    _spTaskQueue *queue = (_spTaskQueue *)arg;
+    while (true) {
+        int index;
+        pthread_mutex_lock(&queue->lock);
+        index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+        if (index >= queue->count) {
+            break;
+        }
+        queue->task(queue->arg, index);
+    }
+    return NULL;
+}
+#endif
+
+static void parallelFor(void *userData, int count, spSkeletonBinaryTaskFunc task, void *arg)
+{
+#ifndef _WIN32
+    pthread_t threads[SKELETONBINARY_MAX_THREADS];
+    int threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    _spTaskQueue queue;
+#endif
+    
+    (void)userData;
+#ifndef _WIN32
+    threadCount = MIN(MIN(threadCount, count), SKELETONBINARY_MAX_THREADS);
+    if (threadCount > 1) {
+        pthread_mutex_init(&queue.lock, NULL);
+        queue.next = 0;
+        queue.count = count;
+        queue.task = task;
+        queue.arg = arg;
+        
+        // the calling thread is one of the workers
+        for (int i = 1; i < threadCount; i++) {
+            if (pthread_create(&threads[i], NULL, runTasks, &queue) != 0) {
+                threadCount = i;
+                break;
+            }
+        }
+        runTasks(&queue);
+        for (int i = 1; i < threadCount; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        pthread_mutex_destroy(&queue.lock);
+        return;
+    }
+#endif
+    
+    for (int i = 0; i < count; i++) {
+        task(arg, i);
+    }
+}
+
+static spSkeletonData *readParallelSkeletonData(spSkeletonBinary *self, spSkeletonBinaryParallelFunc parallel, void *userData)
+{
+    spSkeletonData *skeketon;
+    int count;
+    
+    readLazySkeletonData(self);
+    skeketon = self->skeletonData;
+    count = skeketon->animationsCount;
+    
+    if (count > 0) {
+        _spParallelDecode decode;
+        _spAnimationSpan *spans = (_spAnimationSpan *)malloc(sizeof(_spAnimationSpan) * count);
+        
+        // hand out the biggest animations first so the workers finish together
+        for (int i = 0; i < count; i++) {
+            spans[i].index = i;
+            spans[i].offset = self->animationOffsets[i];
+            spans[i].length = (i + 1 < count ? self->animationOffsets[i + 1] : self->data->capacity) - spans[i].offset;
+        }
+        qsort(spans, count, sizeof(_spAnimationSpan), compareAnimationSpan);
+        
+        decode.binary = self;
+        decode.order = (int *)malloc(sizeof(int) * count);
+        memset(&decode.frames, 0, sizeof(decode.frames));
+        for (int i = 0; i < count; i++) {
+            decode.order[i] = spans[i].index;
+        }
+        free(spans);
+        
+        if (self->arena) {
+            self->arena->shared = true;
+        }
+        (parallel ? parallel : parallelFor)(userData, count, decodeAnimationTask, &decode);
+        if (self->arena) {
+            self->arena->shared = false;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            self->animationOffsets[i] = -1;
+        }
+        free(decode.order);
+        freeFrameTable(&decode.frames);
+    }
+    
+    self->skeletonData = NULL;
+    spSkeletonBinary_dispose(self);
+    
+    return skeketon;
+}
+
+spSkeletonData *spSkeletonBinary_readSkeletonDataParallel(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale, spSkeletonBinaryParallelFunc parallel, void *userData)
+{
+    spSkeletonBinary *self;
+    bool mapped;
+    int length;
+    char *content = openImage(skeketonPath, &length, &mapped);
+    
+    if (content == NULL) {
+        return NULL;
+    }
+    
+    self = createSkeletonBinary(attachmentLoader, scale);
+    self->image = content;
+    self->imageLength = length;
+    self->imageMapped = mapped;
+    self->data->capacity = length;
+    self->data->content = content;
+    
+    return readParallelSkeletonData(self, parallel, userData);
+}
+
+spSkeletonData *spSkeletonBinary_readSkeletonDataParallelFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale, spSkeletonBinaryParallelFunc parallel, void *userData)
+{
+    spSkeletonBinary *self = createSkeletonBinary(attachmentLoader, scale);
+    
+    self->data->capacity = (int)length;
+    self->data->content = (char *)content;
+    
+    return readParallelSkeletonData(self, parallel, userData);
+}
+
+typedef struct {
+    spSkeletonBinaryInfo super;
+    _spStringBuffer *strings;
+} _spSkeletonBinaryInfo;
+
+static const char *copyInfoString(_spSkeletonBinaryInfo *info, const char *str)
+{
+    int byteCount;
+    
+    if (str == NULL) {
+        return NULL;
+    }
+    byteCount = (int)strlen(str) + 1;
+    return (const char *)memcpy(allocString(&info->strings, byteCount), str, byteCount);
+}
+
+static spSkeletonBinaryInfo *readInfo(spSkeletonBinary *self)
+{
+    _spSkeletonBinaryInfo *internal = (_spSkeletonBinaryInfo *)calloc(1, sizeof(_spSkeletonBinaryInfo));
+    spSkeletonBinaryInfo *info = &internal->super;
+    _spRegionPaths regions = {0, 0, NULL};
+    int count, attachmentCount, defaultSlotCount, position;
+    bool indexed;
+    
+    // header
+    info->hash = copyInfoString(internal, readString(self));
+    info->version = copyInfoString(internal, readString(self));
+    info->width = readFloat(self);
+    info->height = readFloat(self);
+    readFormat(self);
+    
+    // bones
+    info->bonesCount = readVarint(self, true);
+    info->boneNames = (const char **)malloc(sizeof(const char *) * MAX(info->bonesCount, 1));
+    for (int i = 0; i < info->bonesCount; i++) {
+        info->boneNames[i] = copyInfoString(internal, readString(self));
+        if (i > 0) {
+            readVarint(self, true);
+        }
+        skipBytes(self, sizeof(float) * 8 + 2);
+    }
+    
+    // slots
+    info->slotsCount = readVarint(self, true);
+    info->slotNames = (const char **)malloc(sizeof(const char *) * MAX(info->slotsCount, 1));
+    for (int i = 0; i < info->slotsCount; i++) {
+        info->slotNames[i] = copyInfoString(internal, readString(self));
+        readVarint(self, true);
+        skipBytes(self, 4);
+        skipString(self);
+        readByte(self);
+    }
+    
+    // ik constraints
+    info->ikConstraintsCount = readVarint(self, true);
+    for (int i = 0; i < info->ikConstraintsCount; i++) {
+        skipString(self);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            readVarint(self, true);
+        }
+        readVarint(self, true);
+        skipBytes(self, sizeof(float) + 1);
+    }
+    
+    // transform constraints
+    info->transformConstraintsCount = readVarint(self, true);
+    for (int i = 0; i < info->transformConstraintsCount; i++) {
+        skipString(self);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            readVarint(self, true);
+        }
+        readVarint(self, true);
+        skipBytes(self, sizeof(float) * 10);
+    }
+    
+    // path constraints
+    info->pathConstraintsCount = readVarint(self, true);
+    for (int i = 0; i < info->pathConstraintsCount; i++) {
+        skipString(self);
+        for (int ii = 0, nn = readVarint(self, true); ii < nn; ii++) {
+            readVarint(self, true);
+        }
+        readVarint(self, true);
+        readVarint(self, true);
+        readVarint(self, true);
+        readVarint(self, true);
+        skipBytes(self, sizeof(float) * 5);
+    }
+    
+    // default skin, then the named ones. the reader creates the default skin
+    // whenever it lists slots, even when none of them has an attachment
+    position = self->data->position;
+    defaultSlotCount = readVarint(self, true);
+    self->data->position = position;
+    attachmentCount = skipSkin(self, &regions);
+    count = readVarint(self, true);
+    info->skinNames = (const char **)malloc(sizeof(const char *) * (count + 1));
+    if (defaultSlotCount > 0) {
+        info->skinNames[info->skinsCount++] = copyInfoString(internal, "default");
+    }
+    for (int i = 0; i < count; i++) {
+        info->skinNames[info->skinsCount++] = copyInfoString(internal, readString(self));
+        attachmentCount += skipSkin(self, &regions);
+    }
+    info->attachmentsCount = attachmentCount;
+    
+    // distinct regions, sorted
+    if (sortRegionPaths(&regions) > 0) {
+        info->regionPaths = (const char **)malloc(sizeof(const char *) * regions.count);
+        for (int i = 0; i < regions.count; i++) {
+            info->regionPaths[info->regionsCount++] = copyInfoString(internal, regions.paths[i]);
+        }
+    }
+    free(regions.paths);
+    
+    // events
+    info->eventsCount = readVarint(self, true);
+    info->eventNames = (const char **)malloc(sizeof(const char *) * MAX(info->eventsCount, 1));
+    for (int i = 0; i < info->eventsCount; i++) {
+        info->eventNames[i] = copyInfoString(internal, readString(self));
+        readVarint(self, false);
+        skipBytes(self, sizeof(float));
+        skipString(self);
+    }
+    
+    // animations
+    info->animationsCount = readVarint(self, true);
+    info->animationNames = (const char **)malloc(sizeof(const char *) * MAX(info->animationsCount, 1));
+    info->animationDurations = (float *)malloc(sizeof(float) * MAX(info->animationsCount, 1));
+    indexed = self->toc != NULL && self->toc->animationsCount == info->animationsCount;
+    for (int i = 0; i < info->animationsCount; i++) {
+        if (indexed) {
+            self->data->position = self->toc->animations[i];
+        }
+        info->animationNames[i] = copyInfoString(internal, readString(self));
+        info->animationDurations[i] = indexed ? self->toc->durations[i] : skipAnimation(self);
+    }
+    
+    spSkeletonBinary_dispose(self);
+    
+    return info;
+}
+
+spSkeletonBinaryInfo *spSkeletonBinary_readInfo(const char *skeketonPath)
+{
+    spSkeletonBinaryInfo *info;
+    bool mapped;
+    int length;
+    char *content = openImage(skeketonPath, &length, &mapped);
+    
+    if (content == NULL) {
+        return NULL;
+    }
+    
+    info = spSkeletonBinary_readInfoFromMemory(content, length);
+    closeImage(content, length, mapped);
+    
+    return info;
+}
+
+spSkeletonBinaryInfo *spSkeletonBinary_readInfoFromMemory(const void *content, size_t length)
+{
+    spSkeletonBinary *self = createSkeletonBinary(NULL, 1);
+    
+    self->data->capacity = (int)length;
+    self->data->content = (char *)content;
+    
+    return readInfo(self);
+}
+
+void spSkeletonBinaryInfo_dispose(spSkeletonBinaryInfo *self)
+{
+    _spSkeletonBinaryInfo *internal = (_spSkeletonBinaryInfo *)self;
+    
+    freeStringBuffers(&internal->strings);
+    free(self->boneNames);
+    free(self->slotNames);
+    free(self->skinNames);
+    free(self->regionPaths);
+    free(self->eventNames);
+    free(self->animationNames);
+    free(self->animationDurations);
+    free(internal);
+}
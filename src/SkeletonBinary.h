@@ -7,12 +7,222 @@
 
 #include "spine/spine.h"
 
+#include <stddef.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// copies up to size bytes into buffer, returns the number of bytes copied
+// or 0 once the stream is exhausted
+typedef int (*spSkeletonBinaryReadFunc)(void *userData, char *buffer, int size);
+
+// on POSIX systems the file is mmapped for the duration of the load,
+// define SKELETONBINARY_NO_MMAP to always go through _spUtil_readFile
 spSkeletonData *spSkeletonBinary_readSkeletonData(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale);
 
+// decode straight from a caller-owned buffer (e.g. an mmapped archive),
+// content is not copied and only needs to stay valid during the call,
+// unless spSkeletonBinaryOptions keepContent is set
+spSkeletonData *spSkeletonBinary_readSkeletonDataFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale);
+
+// decode through a small refillable window fed by read (fd, archive stream,
+// decompressor...), the file never has to be resident as a whole
+spSkeletonData *spSkeletonBinary_readSkeletonDataFromStream(spSkeletonBinaryReadFunc read, void *userData, spAttachmentLoader *attachmentLoader, float scale);
+
+// gets the sorted, distinct region and mesh paths of every skin in the file
+typedef void (*spSkeletonBinaryPrefetchFunc)(void *userData, const char **regionPaths, int count);
+
+// selective loading: only the listed skins and animations are decoded,
+// the rest is skipped without creating anything (a table of contents,
+// spinec -t, lets the reader jump over them). a NULL list keeps everything
+// of its kind. the default skin is always read, so are skins a listed
+// skin's linked meshes take their parent mesh from; deform timelines of
+// skins that were left out are dropped.
+//
+// prefetch, when set, is called once from a quick scan of the skins
+// (quicker still with a table of contents) right after the header and
+// before anything is decoded, e.g. to start streaming texture pages while
+// the rest loads. deferConfigure holds the attachment loader's
+// configureAttachment calls back until decoding is done and makes them in
+// one batch, in read order; createAttachment still runs as each attachment
+// is read.
+//
+// keepContent is for readSkeletonDataFromMemoryWithOptions: the caller
+// keeps content valid and unchanged until the arena the load is bound to
+// is disposed, so the names of a file written with spinec -z point into
+// content instead of being copied. the arena doesn't count or free content.
+// it does nothing for a heap load, where every name is freed on its own
+typedef struct spSkeletonBinaryOptions {
+    const char **skins;
+    int skinsCount;
+    const char **animations;
+    int animationsCount;
+    
+    spSkeletonBinaryPrefetchFunc prefetch;
+    void *userData;
+    bool deferConfigure;
+    bool keepContent;
+} spSkeletonBinaryOptions;
+
+spSkeletonData *spSkeletonBinary_readSkeletonDataWithOptions(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale, const spSkeletonBinaryOptions *options);
+spSkeletonData *spSkeletonBinary_readSkeletonDataFromMemoryWithOptions(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale, const spSkeletonBinaryOptions *options);
+
+// lazy loading: bones, slots, constraints, skins and events are decoded
+// up front, animations only get their name and duration from a quick skip
+// pass and are decoded in place the first time spSkeletonBinary_getAnimation
+// or spSkeletonBinary_findAnimation asks for them. the reader keeps the file
+// image (or the caller's content) until spSkeletonBinary_dispose, which does
+// not dispose the skeleton data; not thread safe.
+//
+// WARNING: until then skeletonData->animations holds empty placeholders.
+// spSkeletonData_findAnimation, spAnimationState_setAnimationByName and
+// anything else that reaches an animation through the skeleton data get
+// one without timelines that silently plays nothing. look animations up
+// with spSkeletonBinary_getAnimation/findAnimation only, or call
+// spSkeletonBinary_getAnimation for every index before handing the
+// skeleton data to code that uses the runtime lookups
+typedef struct spSkeletonBinary spSkeletonBinary;
+
+spSkeletonBinary *spSkeletonBinary_createLazy(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale);
+spSkeletonBinary *spSkeletonBinary_createLazyFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale);
+void spSkeletonBinary_dispose(spSkeletonBinary *self);
+spSkeletonData *spSkeletonBinary_getSkeletonData(spSkeletonBinary *self);
+spAnimation *spSkeletonBinary_getAnimation(spSkeletonBinary *self, int index);
+spAnimation *spSkeletonBinary_findAnimation(spSkeletonBinary *self, const char *animationName);
+
+// time-sliced loading, to spread a big load over frames: begin opens the
+// file (or takes the caller's content, which has to stay valid until
+// finish) without decoding anything, each step decodes items, a bone, slot,
+// constraint, skin, linked mesh, event or animation at a time, until budget
+// microseconds are spent and returns true once nothing is left; an item that
+// alone takes longer than the budget still runs to its end. finish decodes
+// the rest, disposes the reader and returns the skeleton data, disposing
+// the reader instead gives up the load along with the partial skeleton
+// data. steps allocate into the arena that was bound at begin
+spSkeletonBinary *spSkeletonBinary_begin(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale);
+spSkeletonBinary *spSkeletonBinary_beginFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale);
+bool spSkeletonBinary_step(spSkeletonBinary *self, int budget);
+spSkeletonData *spSkeletonBinary_finish(spSkeletonBinary *self);
+
+// parallel loading: animations are located with the lazy skip pass, then
+// decoded concurrently, each task on its own cursor over the shared image.
+// parallel runs task(arg, index) for every index in [0, count) on any
+// threads and returns once all of them finished; pass NULL to use one
+// pthread per online cpu (sequential where pthreads aren't available)
+typedef void (*spSkeletonBinaryTaskFunc)(void *arg, int index);
+typedef void (*spSkeletonBinaryParallelFunc)(void *userData, int count, spSkeletonBinaryTaskFunc task, void *arg);
+
+spSkeletonData *spSkeletonBinary_readSkeletonDataParallel(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale, spSkeletonBinaryParallelFunc parallel, void *userData);
+spSkeletonData *spSkeletonBinary_readSkeletonDataParallelFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale, spSkeletonBinaryParallelFunc parallel, void *userData);
+
+// O(1) name lookups over loaded skeleton data, a drop-in for the linear
+// spSkeletonData_find* scans in per-frame code. open addressing tables over
+// bone, slot, skin and animation names that only hold indices into the
+// data; build it once the data is complete and dispose it before the data.
+// the lazy reader builds one on its first spSkeletonBinary_findAnimation
+typedef struct spSkeletonBinaryIndex spSkeletonBinaryIndex;
+
+spSkeletonBinaryIndex *spSkeletonBinaryIndex_create(const spSkeletonData *skeletonData);
+void spSkeletonBinaryIndex_dispose(spSkeletonBinaryIndex *self);
+
+// -1 or NULL when there is no such name, the first one wins on duplicates
+int spSkeletonBinaryIndex_findBoneIndex(const spSkeletonBinaryIndex *self, const char *boneName);
+int spSkeletonBinaryIndex_findSlotIndex(const spSkeletonBinaryIndex *self, const char *slotName);
+int spSkeletonBinaryIndex_findSkinIndex(const spSkeletonBinaryIndex *self, const char *skinName);
+int spSkeletonBinaryIndex_findAnimationIndex(const spSkeletonBinaryIndex *self, const char *animationName);
+spBoneData *spSkeletonBinaryIndex_findBone(const spSkeletonBinaryIndex *self, const char *boneName);
+spSlotData *spSkeletonBinaryIndex_findSlot(const spSkeletonBinaryIndex *self, const char *slotName);
+spSkin *spSkeletonBinaryIndex_findSkin(const spSkeletonBinaryIndex *self, const char *skinName);
+spAnimation *spSkeletonBinaryIndex_findAnimation(const spSkeletonBinaryIndex *self, const char *animationName);
+
+// metadata of a .skel file without building the skeleton: names and counts
+// are read as is, attachments, timelines and everything else is skipped.
+// all strings belong to the info and go with spSkeletonBinaryInfo_dispose
+typedef struct spSkeletonBinaryInfo {
+    const char *hash;
+    const char *version;
+    float width, height;
+    
+    int bonesCount;
+    const char **boneNames;
+    
+    int slotsCount;
+    const char **slotNames;
+    
+    int ikConstraintsCount;
+    int transformConstraintsCount;
+    int pathConstraintsCount;
+    
+    // "default" comes first when the default skin has attachments
+    int skinsCount;
+    const char **skinNames;
+    int attachmentsCount;
+    
+    // sorted, distinct atlas regions used by region and mesh attachments
+    int regionsCount;
+    const char **regionPaths;
+    
+    int eventsCount;
+    const char **eventNames;
+    
+    int animationsCount;
+    const char **animationNames;
+    float *animationDurations;
+} spSkeletonBinaryInfo;
+
+spSkeletonBinaryInfo *spSkeletonBinary_readInfo(const char *skeketonPath);
+spSkeletonBinaryInfo *spSkeletonBinary_readInfoFromMemory(const void *content, size_t length);
+void spSkeletonBinaryInfo_dispose(spSkeletonBinaryInfo *self);
+
+// bump allocator that owns everything a skeleton load produces.
+// while an arena is bound to a thread, every spine allocation made on that
+// thread (skeleton data, attachments, timelines, frames, names...) comes
+// from the arena and freeing it is a no-op; the memory is released in one
+// go by spSkeletonBinaryArena_dispose:
+//
+//     spSkeletonBinaryArena *arena = spSkeletonBinaryArena_create(0);
+//     spSkeletonBinaryArena *previous = spSkeletonBinaryArena_bind(arena);
+//     spSkeletonData *data = spSkeletonBinary_readSkeletonData(path, loader, 1);
+//     spSkeletonBinaryArena_bind(previous);
+//     ...
+//     previous = spSkeletonBinaryArena_bind(arena);
+//     spSkeletonData_dispose(data); // optional, only runs attachment loader cleanup
+//     spSkeletonBinaryArena_bind(previous);
+//     spSkeletonBinaryArena_dispose(arena);
+//
+// a free only recognizes memory of the arena bound on its thread, so
+// anything that frees loaded data (spSkeletonData_dispose, spSkin_dispose,
+// a lazy reader's placeholder swap...) must run with the data's arena
+// bound, on any other thread it hands the pointer to the heap. frees on a
+// thread without an arena go straight to the heap.
+// while at least one arena exists, _setMalloc/_setFree hold arena aware
+// hooks that pass everything outside an arena on to the heap given to
+// spSkeletonBinaryArena_setAllocator, libc malloc/free by default; the
+// last spSkeletonBinaryArena_dispose puts that heap back. spine-c can't
+// report the allocator it was handed, so an app with its own allocator
+// installs it with setAllocator instead of _setMalloc/_setFree, and never
+// calls _setMalloc/_setFree while an arena exists. setAllocator refuses
+// and returns false while an arena exists. the hooks are swapped in and out
+// with plain stores, another thread's allocation may see either function
+// meanwhile and both act the same outside an arena.
+// identical deform frames are stored once by every load; on the heap they
+// are reference counted and released by the deform timeline's dispose, so
+// don't replace them with spDeformTimeline_setFrame. inside an arena
+// repeated names are stored once too, a heap load copies each name.
+// a file written with spinec -z that a path based load maps into an arena
+// stays mapped until the arena is disposed and the names point into it,
+// spSkeletonBinaryArena_getSize counts the mapping. a memory load does the
+// same with the caller's buffer when asked to, see keepContent
+typedef struct spSkeletonBinaryArena spSkeletonBinaryArena;
+
+spSkeletonBinaryArena *spSkeletonBinaryArena_create(size_t blockSize);
+void spSkeletonBinaryArena_dispose(spSkeletonBinaryArena *self);
+size_t spSkeletonBinaryArena_getSize(const spSkeletonBinaryArena *self);
+spSkeletonBinaryArena *spSkeletonBinaryArena_bind(spSkeletonBinaryArena *self);
+bool spSkeletonBinaryArena_setAllocator(void *(*mallocFunc)(size_t size), void (*freeFunc)(void *ptr));
+
 #ifdef __cplusplus
 }
 #endif
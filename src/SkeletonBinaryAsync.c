@@ -0,0 +1,351 @@
+//
+// $id: SkeletonBinaryAsync.c https://github.com/zhongfq/spine-binaryreader $
+//
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+// _POSIX_C_SOURCE hides _SC_NPROCESSORS_ONLN on darwin
+#if defined(__APPLE__) && !defined(_DARWIN_C_SOURCE)
+#define _DARWIN_C_SOURCE
+#endif
+
+#include "SkeletonBinaryAsync.h"
+#include "SkeletonBinaryThread.h"
+#include "spine/extension.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#define ASYNC_MAX_THREADS 8
+
+struct spSkeletonBinaryJob {
+    struct spSkeletonBinaryJob *next;
+    
+    // path is NULL for memory jobs
+    char *path;
+    const void *content;
+    size_t length;
+    spAttachmentLoader *attachmentLoader;
+    float scale;
+    
+    int priority;
+    spSkeletonBinaryJobFunc callback;
+    void *userData;
+    
+    spSkeletonBinaryJobState state;
+    spSkeletonData *skeletonData;
+    
+    // the caller's handle and the pool's while queued or loading
+    int refCount;
+    bool released;
+};
+
+static _spLock _lock = LOCK_INITIALIZER;
+static _spCondition _queued = CONDITION_INITIALIZER;
+static _spCondition _finished = CONDITION_INITIALIZER;
+
+// sorted by priority, highest first
+static spSkeletonBinaryJob *_queue = NULL;
+
+static _spThread _threads[ASYNC_MAX_THREADS];
+static int _threadsCount = 0;
+static int _threadCount = 0;
+static bool _stopping = false;
+
+static int getDefaultThreadCount(void)
+{
+    int cpuCount;
+    
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    cpuCount = (int)info.dwNumberOfProcessors;
+#else
+    cpuCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    
+    // leave a core to the thread that submits the jobs
+    return MAX(cpuCount - 1, 1);
+}
+
+static void freeJob(spSkeletonBinaryJob *job)
+{
+    free(job->path);
+    free(job);
+}
+
+// FIFO among equal priorities
+static void enqueueJob(spSkeletonBinaryJob *job)
+{
+    spSkeletonBinaryJob **link = &_queue;
+    while (*link && (*link)->priority >= job->priority) {
+        link = &(*link)->next;
+    }
+    job->next = *link;
+    *link = job;
+}
+
+static void unlinkJob(spSkeletonBinaryJob *job)
+{
+    spSkeletonBinaryJob **link = &_queue;
+    while (*link != job) {
+        link = &(*link)->next;
+    }
+    *link = job->next;
+    job->next = NULL;
+}
+
+// drops the pool's reference of a job that leaves the queue unrun,
+// returns true when the caller has to free it
+static bool cancelJob(spSkeletonBinaryJob *job)
+{
+    unlinkJob(job);
+    job->state = SP_SKELETONBINARY_JOB_CANCELED;
+    CONDITION_BROADCAST(_finished);
+    return --job->refCount == 0;
+}
+
+static THREAD_FUNC(runJobs, arg)
+{
+    (void)arg;
+    LOCK(_lock);
+    while (true) {
+        spSkeletonBinaryJob *job;
+        spSkeletonData *skeletonData;
+        bool orphaned;
+        
+        while (_queue == NULL && !_stopping) {
+            CONDITION_WAIT(_queued, _lock);
+        }
+        if (_queue == NULL) {
+            break;
+        }
+        
+        job = _queue;
+        _queue = job->next;
+        job->next = NULL;
+        job->state = SP_SKELETONBINARY_JOB_LOADING;
+        UNLOCK(_lock);
+        
+        if (job->path) {
+            skeletonData = spSkeletonBinary_readSkeletonData(job->path, job->attachmentLoader, job->scale);
+        } else {
+            skeletonData = spSkeletonBinary_readSkeletonDataFromMemory(job->content, job->length, job->attachmentLoader, job->scale);
+        }
+        if (job->callback) {
+            job->callback(job, skeletonData, job->userData);
+        }
+        
+        LOCK(_lock);
+        orphaned = job->released && job->callback == NULL;
+        job->skeletonData = orphaned ? NULL : skeletonData;
+        job->state = SP_SKELETONBINARY_JOB_DONE;
+        CONDITION_BROADCAST(_finished);
+        if (--job->refCount == 0) {
+            freeJob(job);
+        }
+        UNLOCK(_lock);
+        
+        // nobody is left to take it
+        if (orphaned && skeletonData) {
+            spSkeletonData_dispose(skeletonData);
+        }
+        
+        LOCK(_lock);
+    }
+    UNLOCK(_lock);
+    
+    THREAD_RETURN;
+}
+
+// caller holds _lock
+static void startThreads(void)
+{
+    int threadCount = _threadCount > 0 ? _threadCount : getDefaultThreadCount();
+    
+    threadCount = MIN(threadCount, ASYNC_MAX_THREADS);
+    while (_threadsCount < threadCount && THREAD_CREATE(_threads[_threadsCount], runJobs, NULL)) {
+        _threadsCount++;
+    }
+}
+
+static spSkeletonBinaryJob *submitJob(spSkeletonBinaryJob *job)
+{
+    job->next = NULL;
+    job->state = SP_SKELETONBINARY_JOB_QUEUED;
+    job->skeletonData = NULL;
+    job->refCount = 2;
+    job->released = false;
+    
+    LOCK(_lock);
+    if (_threadsCount == 0 && !_stopping) {
+        startThreads();
+    }
+    if (_threadsCount == 0 || _stopping) {
+        // no thread could be started or the pool is shutting down, the job never runs
+        job->state = SP_SKELETONBINARY_JOB_CANCELED;
+        job->refCount = 1;
+    } else {
+        enqueueJob(job);
+        CONDITION_BROADCAST(_queued);
+    }
+    UNLOCK(_lock);
+    
+    return job;
+}
+
+spSkeletonBinaryJob *spSkeletonBinaryAsync_load(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale, int priority, spSkeletonBinaryJobFunc callback, void *userData)
+{
+    spSkeletonBinaryJob *job = (spSkeletonBinaryJob *)malloc(sizeof(spSkeletonBinaryJob));
+    job->path = (char *)malloc(strlen(skeketonPath) + 1);
+    strcpy(job->path, skeketonPath);
+    job->content = NULL;
+    job->length = 0;
+    job->attachmentLoader = attachmentLoader;
+    job->scale = scale;
+    job->priority = priority;
+    job->callback = callback;
+    job->userData = userData;
+    
+    return submitJob(job);
+}
+
+spSkeletonBinaryJob *spSkeletonBinaryAsync_loadFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale, int priority, spSkeletonBinaryJobFunc callback, void *userData)
+{
+    spSkeletonBinaryJob *job = (spSkeletonBinaryJob *)malloc(sizeof(spSkeletonBinaryJob));
+    job->path = NULL;
+    job->content = content;
+    job->length = length;
+    job->attachmentLoader = attachmentLoader;
+    job->scale = scale;
+    job->priority = priority;
+    job->callback = callback;
+    job->userData = userData;
+    
+    return submitJob(job);
+}
+
+void spSkeletonBinaryAsync_setThreadCount(int threadCount)
+{
+    LOCK(_lock);
+    _threadCount = threadCount;
+    UNLOCK(_lock);
+}
+
+void spSkeletonBinaryAsync_shutdown(void)
+{
+    spSkeletonBinaryJob *canceled = NULL;
+    int threadsCount;
+    
+    LOCK(_lock);
+    while (_queue) {
+        spSkeletonBinaryJob *job = _queue;
+        if (cancelJob(job)) {
+            job->next = canceled;
+            canceled = job;
+        }
+    }
+    _stopping = true;
+    CONDITION_BROADCAST(_queued);
+    threadsCount = _threadsCount;
+    UNLOCK(_lock);
+    
+    while (canceled) {
+        spSkeletonBinaryJob *next = canceled->next;
+        freeJob(canceled);
+        canceled = next;
+    }
+    
+    for (int i = 0; i < threadsCount; i++) {
+        THREAD_JOIN(_threads[i]);
+    }
+    
+    LOCK(_lock);
+    _threadsCount = 0;
+    _stopping = false;
+    UNLOCK(_lock);
+}
+
+spSkeletonBinaryJobState spSkeletonBinaryJob_getState(spSkeletonBinaryJob *self)
+{
+    spSkeletonBinaryJobState state;
+    
+    LOCK(_lock);
+    state = self->state;
+    UNLOCK(_lock);
+    
+    return state;
+}
+
+spSkeletonData *spSkeletonBinaryJob_getSkeletonData(spSkeletonBinaryJob *self)
+{
+    spSkeletonData *skeletonData;
+    
+    LOCK(_lock);
+    skeletonData = self->skeletonData;
+    UNLOCK(_lock);
+    
+    return skeletonData;
+}
+
+spSkeletonData *spSkeletonBinaryJob_wait(spSkeletonBinaryJob *self)
+{
+    spSkeletonData *skeletonData;
+    
+    LOCK(_lock);
+    while (self->state == SP_SKELETONBINARY_JOB_QUEUED || self->state == SP_SKELETONBINARY_JOB_LOADING) {
+        CONDITION_WAIT(_finished, _lock);
+    }
+    skeletonData = self->skeletonData;
+    UNLOCK(_lock);
+    
+    return skeletonData;
+}
+
+bool spSkeletonBinaryJob_cancel(spSkeletonBinaryJob *self)
+{
+    bool canceled = false;
+    
+    LOCK(_lock);
+    if (self->state == SP_SKELETONBINARY_JOB_QUEUED) {
+        // the caller still holds its handle, so this never frees the job
+        cancelJob(self);
+        canceled = true;
+    }
+    UNLOCK(_lock);
+    
+    return canceled;
+}
+
+void spSkeletonBinaryJob_setPriority(spSkeletonBinaryJob *self, int priority)
+{
+    LOCK(_lock);
+    self->priority = priority;
+    if (self->state == SP_SKELETONBINARY_JOB_QUEUED) {
+        unlinkJob(self);
+        enqueueJob(self);
+    }
+    UNLOCK(_lock);
+}
+
+void spSkeletonBinaryJob_release(spSkeletonBinaryJob *self)
+{
+    bool unused;
+    
+    LOCK(_lock);
+    if (self->state == SP_SKELETONBINARY_JOB_QUEUED) {
+        cancelJob(self);
+    }
+    self->released = true;
+    unused = --self->refCount == 0;
+    UNLOCK(_lock);
+    
+    if (unused) {
+        freeJob(self);
+    }
+}
@@ -0,0 +1,83 @@
+//
+// $id: SkeletonBinaryAsync.h https://github.com/zhongfq/spine-binaryreader $
+//
+
+#ifndef __SKELETONBINARYASYNC_H__
+#define __SKELETONBINARYASYNC_H__
+
+#include "SkeletonBinary.h"
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// asynchronous loading on a process-wide pool of worker threads, started
+// by the first load. queued jobs run highest priority first, in submission
+// order among equal priorities. a job ends up done, with the skeleton data
+// or NULL when the load failed, or canceled when it never started.
+//
+// thread contract: a job runs spSkeletonBinary_readSkeletonData on a
+// worker, so everything the load calls happens on that thread: the
+// attachment loader's createAttachment and configureAttachment, the spine
+// allocator (_malloc/_free hooks) and _spUtil_readFile for non-mmapped
+// files. jobs on different workers call them concurrently, so the
+// attachment loader must be thread safe (an spAtlasAttachmentLoader over an
+// atlas nobody modifies meanwhile is), or use one loader per job, or
+// setThreadCount(1) to run the jobs one after the other. an arena bound on
+// the submitting thread does not apply to the worker, and a job never
+// touches the allocator hooks: _setMalloc/_setFree stay as the app left them
+typedef struct spSkeletonBinaryJob spSkeletonBinaryJob;
+
+typedef enum {
+    SP_SKELETONBINARY_JOB_QUEUED,
+    SP_SKELETONBINARY_JOB_LOADING,
+    SP_SKELETONBINARY_JOB_DONE,
+    SP_SKELETONBINARY_JOB_CANCELED
+} spSkeletonBinaryJobState;
+
+// runs on the worker thread once the load finished, before the job turns
+// done. the skeleton data (NULL on failure) belongs to the caller, it is
+// the same pointer spSkeletonBinaryJob_wait returns
+typedef void (*spSkeletonBinaryJobFunc)(spSkeletonBinaryJob *job, spSkeletonData *skeletonData, void *userData);
+
+// callback may be NULL to only poll the returned handle. content of a
+// memory job must stay valid until the job is done or canceled
+spSkeletonBinaryJob *spSkeletonBinaryAsync_load(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale, int priority, spSkeletonBinaryJobFunc callback, void *userData);
+spSkeletonBinaryJob *spSkeletonBinaryAsync_loadFromMemory(const void *content, size_t length, spAttachmentLoader *attachmentLoader, float scale, int priority, spSkeletonBinaryJobFunc callback, void *userData);
+
+// worker count of the pool, 0 for one less than the online cpus (at least
+// one). takes effect when the pool starts, i.e. before the first load or
+// after spSkeletonBinaryAsync_shutdown
+void spSkeletonBinaryAsync_setThreadCount(int threadCount);
+
+// cancels every queued job and waits for the running ones to finish
+void spSkeletonBinaryAsync_shutdown(void);
+
+spSkeletonBinaryJobState spSkeletonBinaryJob_getState(spSkeletonBinaryJob *self);
+
+// NULL until the job is done
+spSkeletonData *spSkeletonBinaryJob_getSkeletonData(spSkeletonBinaryJob *self);
+
+// blocks until the job is done or canceled, returns its skeleton data
+spSkeletonData *spSkeletonBinaryJob_wait(spSkeletonBinaryJob *self);
+
+// returns true when the job was still queued and will never run,
+// a job that is already loading runs to the end
+bool spSkeletonBinaryJob_cancel(spSkeletonBinaryJob *self);
+
+// reorders a queued job, no effect once it started
+void spSkeletonBinaryJob_setPriority(spSkeletonBinaryJob *self, int priority);
+
+// drops the handle, every job must be released once. a queued job is
+// canceled; a job that is loading still calls its callback, without one
+// its skeleton data is disposed. skeleton data of a done job is the
+// caller's and stays alive
+void spSkeletonBinaryJob_release(spSkeletonBinaryJob *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
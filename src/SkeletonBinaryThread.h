@@ -0,0 +1,52 @@
+//
+// $id: SkeletonBinaryThread.h https://github.com/zhongfq/spine-binaryreader $
+//
+
+#ifndef __SKELETONBINARYTHREAD_H__
+#define __SKELETONBINARYTHREAD_H__
+
+// private locking and thread primitives shared by the binary reader and its helpers
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef SRWLOCK _spLock;
+typedef CONDITION_VARIABLE _spCondition;
+typedef HANDLE _spThread;
+
+#define LOCK_INITIALIZER        SRWLOCK_INIT
+#define CONDITION_INITIALIZER   CONDITION_VARIABLE_INIT
+#define LOCK(l)                 AcquireSRWLockExclusive(&(l))
+#define UNLOCK(l)               ReleaseSRWLockExclusive(&(l))
+#define CONDITION_WAIT(c, l)    SleepConditionVariableSRW(&(c), &(l), INFINITE, 0)
+#define CONDITION_BROADCAST(c)  WakeAllConditionVariable(&(c))
+#define THREAD_FUNC(f, arg)     DWORD WINAPI f(LPVOID arg)
+#define THREAD_RETURN           return 0
+#define THREAD_CREATE(t, f, a)  (((t) = CreateThread(NULL, 0, f, a, 0, NULL)) != NULL)
+#define THREAD_JOIN(t)          (WaitForSingleObject(t, INFINITE), CloseHandle(t))
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t _spLock;
+typedef pthread_cond_t _spCondition;
+typedef pthread_t _spThread;
+
+#define LOCK_INITIALIZER        PTHREAD_MUTEX_INITIALIZER
+#define CONDITION_INITIALIZER   PTHREAD_COND_INITIALIZER
+#define LOCK(l)                 pthread_mutex_lock(&(l))
+#define UNLOCK(l)               pthread_mutex_unlock(&(l))
+#define CONDITION_WAIT(c, l)    pthread_cond_wait(&(c), &(l))
+#define CONDITION_BROADCAST(c)  pthread_cond_broadcast(&(c))
+#define THREAD_FUNC(f, arg)     void *f(void *arg)
+#define THREAD_RETURN           return NULL
+#define THREAD_CREATE(t, f, a)  (pthread_create(&(t), NULL, f, a) == 0)
+#define THREAD_JOIN(t)          pthread_join(t, NULL)
+#endif
+
+#endif
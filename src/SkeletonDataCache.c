@@ -0,0 +1,267 @@
+//
+// $id: SkeletonDataCache.c https://github.com/zhongfq/spine-binaryreader $
+//
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "SkeletonDataCache.h"
+#include "SkeletonBinaryThread.h"
+#include "spine/extension.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define CACHE_DEFAULT_BUDGET (16 * 1024 * 1024)
+
+typedef struct _spCacheEntry {
+    struct _spCacheEntry *next;
+    
+    char *path;
+    spAttachmentLoader *attachmentLoader;
+    float scale;
+    
+    spSkeletonData *skeletonData;
+    spSkeletonBinaryArena *arena;
+    size_t size;
+    
+    int refCount;
+    bool loading;
+    bool detached;
+    unsigned int lastUse;
+} _spCacheEntry;
+
+static _spLock _lock = LOCK_INITIALIZER;
+static _spCondition _loaded = CONDITION_INITIALIZER;
+
+static _spCacheEntry *_entries = NULL;
+static size_t _size = 0;
+static size_t _budget = CACHE_DEFAULT_BUDGET;
+static unsigned int _clock = 0;
+
+static void disposeEntry(_spCacheEntry *entry)
+{
+    if (entry->skeletonData) {
+        // frees into the bound arena are no-ops, this only runs attachment loader cleanup
+        spSkeletonBinaryArena *arena = spSkeletonBinaryArena_bind(entry->arena);
+        spSkeletonData_dispose(entry->skeletonData);
+        spSkeletonBinaryArena_bind(arena);
+    }
+    if (entry->arena) {
+        spSkeletonBinaryArena_dispose(entry->arena);
+    }
+    free(entry->path);
+    free(entry);
+}
+
+static void unlinkEntry(_spCacheEntry *entry)
+{
+    _spCacheEntry **link = &_entries;
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    _size -= entry->size;
+}
+
+// unlinks unreferenced entries, oldest first, until the cache fits in budget
+// and returns them chained through next so they can be disposed unlocked
+static _spCacheEntry *trimEntries(size_t budget)
+{
+    _spCacheEntry *victims = NULL;
+    
+    while (_size > budget) {
+        _spCacheEntry *oldest = NULL;
+        for (_spCacheEntry *entry = _entries; entry; entry = entry->next) {
+            if (entry->refCount == 0 && !entry->loading && (oldest == NULL || entry->lastUse < oldest->lastUse)) {
+                oldest = entry;
+            }
+        }
+        if (oldest == NULL) {
+            break;
+        }
+        unlinkEntry(oldest);
+        oldest->next = victims;
+        victims = oldest;
+    }
+    
+    return victims;
+}
+
+static void disposeEntries(_spCacheEntry *entries)
+{
+    while (entries) {
+        _spCacheEntry *next = entries->next;
+        disposeEntry(entries);
+        entries = next;
+    }
+}
+
+static _spCacheEntry *findEntry(const char *path, spAttachmentLoader *attachmentLoader, float scale)
+{
+    for (_spCacheEntry *entry = _entries; entry; entry = entry->next) {
+        if (!entry->detached && entry->attachmentLoader == attachmentLoader && entry->scale == scale && strcmp(entry->path, path) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+spSkeletonData *spSkeletonDataCache_acquire(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale)
+{
+    _spCacheEntry *entry;
+    _spCacheEntry *victims;
+    spSkeletonBinaryArena *arena;
+    spSkeletonData *skeletonData;
+    
+    LOCK(_lock);
+    entry = findEntry(skeketonPath, attachmentLoader, scale);
+    if (entry) {
+        entry->refCount++;
+        while (entry->loading) {
+            CONDITION_WAIT(_loaded, _lock);
+        }
+        skeletonData = entry->skeletonData;
+        if (skeletonData == NULL && --entry->refCount == 0) {
+            // the load failed and the loader already unlinked the entry,
+            // the last waiter disposes it
+            UNLOCK(_lock);
+            disposeEntry(entry);
+            return NULL;
+        }
+        UNLOCK(_lock);
+        return skeletonData;
+    }
+    
+    entry = (_spCacheEntry *)malloc(sizeof(_spCacheEntry));
+    entry->path = (char *)malloc(strlen(skeketonPath) + 1);
+    strcpy(entry->path, skeketonPath);
+    entry->attachmentLoader = attachmentLoader;
+    entry->scale = scale;
+    entry->skeletonData = NULL;
+    entry->arena = NULL;
+    entry->size = 0;
+    entry->refCount = 1;
+    entry->loading = true;
+    entry->detached = false;
+    entry->lastUse = 0;
+    entry->next = _entries;
+    _entries = entry;
+    UNLOCK(_lock);
+    
+    // a private arena gives an exact size for the budget and a cheap eviction
+    entry->arena = spSkeletonBinaryArena_create(0);
+    arena = spSkeletonBinaryArena_bind(entry->arena);
+    skeletonData = spSkeletonBinary_readSkeletonData(skeketonPath, attachmentLoader, scale);
+    spSkeletonBinaryArena_bind(arena);
+    
+    LOCK(_lock);
+    entry->loading = false;
+    entry->skeletonData = skeletonData;
+    CONDITION_BROADCAST(_loaded);
+    if (skeletonData == NULL) {
+        // unlinked right away so the next acquire loads again instead of
+        // finding the failure, waiters still hold their own references
+        unlinkEntry(entry);
+        if (--entry->refCount == 0) {
+            UNLOCK(_lock);
+            disposeEntry(entry);
+            return NULL;
+        }
+        UNLOCK(_lock);
+        return NULL;
+    }
+    entry->size = spSkeletonBinaryArena_getSize(entry->arena);
+    _size += entry->size;
+    victims = trimEntries(_budget);
+    UNLOCK(_lock);
+    
+    disposeEntries(victims);
+    return skeletonData;
+}
+
+void spSkeletonDataCache_release(spSkeletonData *skeletonData)
+{
+    _spCacheEntry *victims = NULL;
+    
+    if (skeletonData == NULL) {
+        return;
+    }
+    
+    LOCK(_lock);
+    for (_spCacheEntry *entry = _entries; entry; entry = entry->next) {
+        if (entry->skeletonData == skeletonData) {
+            entry->lastUse = ++_clock;
+            if (--entry->refCount == 0) {
+                victims = trimEntries(_budget);
+            }
+            break;
+        }
+    }
+    UNLOCK(_lock);
+    
+    disposeEntries(victims);
+}
+
+void spSkeletonDataCache_setBudget(size_t budget)
+{
+    _spCacheEntry *victims;
+    
+    LOCK(_lock);
+    _budget = budget;
+    victims = trimEntries(_budget);
+    UNLOCK(_lock);
+    
+    disposeEntries(victims);
+}
+
+size_t spSkeletonDataCache_getSize(void)
+{
+    size_t size;
+    
+    LOCK(_lock);
+    size = _size;
+    UNLOCK(_lock);
+    
+    return size;
+}
+
+void spSkeletonDataCache_purge(void)
+{
+    _spCacheEntry *victims;
+    
+    LOCK(_lock);
+    victims = trimEntries(0);
+    UNLOCK(_lock);
+    
+    disposeEntries(victims);
+}
+
+void spSkeletonDataCache_purgeLoader(spAttachmentLoader *attachmentLoader)
+{
+    _spCacheEntry *victims = NULL;
+    _spCacheEntry **link;
+    
+    LOCK(_lock);
+    link = &_entries;
+    while (*link) {
+        _spCacheEntry *entry = *link;
+        if (entry->attachmentLoader != attachmentLoader) {
+            link = &entry->next;
+        } else if (entry->refCount == 0 && !entry->loading) {
+            *link = entry->next;
+            _size -= entry->size;
+            entry->next = victims;
+            victims = entry;
+        } else {
+            // still held, a loader allocated at the same address must not find it
+            entry->detached = true;
+            link = &entry->next;
+        }
+    }
+    UNLOCK(_lock);
+    
+    disposeEntries(victims);
+}
@@ -0,0 +1,41 @@
+//
+// $id: SkeletonDataCache.h https://github.com/zhongfq/spine-binaryreader $
+//
+
+#ifndef __SKELETONDATACACHE_H__
+#define __SKELETONDATACACHE_H__
+
+#include "SkeletonBinary.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// process-wide, reference counted cache around spSkeletonBinary_readSkeletonData.
+// acquiring the same (path, attachmentLoader, scale) returns the same
+// spSkeletonData, concurrent acquires of a key that is still loading wait
+// for that load instead of parsing the file again. every entry lives in its
+// own spSkeletonBinaryArena, entries nobody holds are kept for reuse until
+// the cache outgrows its budget, then the least recently released go first
+spSkeletonData *spSkeletonDataCache_acquire(const char *skeketonPath, spAttachmentLoader *attachmentLoader, float scale);
+void spSkeletonDataCache_release(spSkeletonData *skeletonData);
+
+// bytes all cached entries may occupy, the mapped -z files their arenas
+// keep included, 16 MB by default
+void spSkeletonDataCache_setBudget(size_t budget);
+size_t spSkeletonDataCache_getSize(void);
+
+// disposes every entry that isn't acquired
+void spSkeletonDataCache_purge(void);
+
+// entries are keyed on the attachment loader's address, call this before
+// disposing a loader so its unheld entries go with it and held ones are no
+// longer handed out to a new loader that reuses the address. data still
+// acquired from those entries must be released before the loader goes
+void spSkeletonDataCache_purgeLoader(spAttachmentLoader *attachmentLoader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
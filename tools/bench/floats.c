@@ -0,0 +1,103 @@
+//
+// $id: floats.c https://github.com/zhongfq/spine-binaryreader $
+//
+
+// readFloatArray against the readFloat loop it replaced. both walk a big
+// endian buffer much larger than the caches in mesh sized arrays, the
+// results must match bit for bit with and without a scale.
+//
+//   floats [floats per array]
+
+#include "SkeletonBinary.c"
+
+#define BUFFER_FLOATS   (16 * 1024 * 1024)
+#define ROUNDS          5
+
+typedef void (*_spDecodeFunc)(spSkeletonBinary *self, float *arr, int length, float scale);
+
+static void readFloatLoop(spSkeletonBinary *self, float *arr, int length, float scale)
+{
+    for (int i = 0; i < length; i++) {
+        arr[i] = readFloat(self) * scale;
+    }
+}
+
+// best of ROUNDS passes over the whole buffer, in GB/s of encoded floats
+static double measure(spSkeletonBinary *self, _spDecodeFunc decode, float *dest, int arrayLength, float scale)
+{
+    int64_t best = INT64_MAX;
+    
+    for (int round = 0; round < ROUNDS; round++) {
+        int64_t start = getMicroseconds();
+        self->data->position = 0;
+        for (int i = 0; i < BUFFER_FLOATS; i += arrayLength) {
+            decode(self, dest + i, MIN(arrayLength, BUFFER_FLOATS - i), scale);
+        }
+        best = MIN(best, getMicroseconds() - start);
+    }
+    
+    return (double)BUFFER_FLOATS * 4 / (double)MAX(best, 1) / 1000;
+}
+
+int main(int argc, char *argv[])
+{
+    int arrayLength = argc > 1 ? atoi(argv[1]) : 256;
+    static const float scales[] = {1, 0.01f};
+    unsigned char *src = (unsigned char *)malloc((size_t)BUFFER_FLOATS * 4);
+    float *expected = (float *)malloc(sizeof(float) * BUFFER_FLOATS);
+    float *actual = (float *)malloc(sizeof(float) * BUFFER_FLOATS);
+    spSkeletonBinary *self = createSkeletonBinary(NULL, 1);
+    int failed = 0;
+    
+    if (arrayLength <= 0) {
+        arrayLength = 256;
+    }
+    
+    // coordinates as an editor exports them, a few odd values mixed in
+    srand(1);
+    for (int i = 0; i < BUFFER_FLOATS; i++) {
+        union {
+            float f;
+            unsigned int i;
+        } u;
+        
+        switch (rand() % 64) {
+            case 0: u.f = 0; break;
+            case 1: u.f = -0.0f; break;
+            case 2: u.f = 1e-40f; break;
+            default: u.f = ((float)rand() / RAND_MAX - 0.5f) * 4096; break;
+        }
+        src[i * 4 + 0] = (unsigned char)(u.i >> 24);
+        src[i * 4 + 1] = (unsigned char)(u.i >> 16);
+        src[i * 4 + 2] = (unsigned char)(u.i >> 8);
+        src[i * 4 + 3] = (unsigned char)u.i;
+    }
+    self->data->content = (char *)src;
+    self->data->capacity = BUFFER_FLOATS * 4;
+    
+#if defined(SKELETONBINARY_SSE2)
+    printf("decodeFloats: sse2, %d floats per array\n", arrayLength);
+#elif defined(SKELETONBINARY_NEON)
+    printf("decodeFloats: neon, %d floats per array\n", arrayLength);
+#else
+    printf("decodeFloats: scalar, %d floats per array\n", arrayLength);
+#endif
+    
+    for (int i = 0; i < (int)(sizeof(scales) / sizeof(scales[0])); i++) {
+        double before = measure(self, readFloatLoop, expected, arrayLength, scales[i]);
+        double after = measure(self, readFloatArray, actual, arrayLength, scales[i]);
+        bool same = memcmp(expected, actual, sizeof(float) * BUFFER_FLOATS) == 0;
+        
+        printf("scale %-5g readFloat %6.2f GB/s  readFloatArray %6.2f GB/s  %.2fx  %s\n",
+               scales[i], before, after, after / before, same ? "bit exact" : "MISMATCH");
+        failed |= !same;
+    }
+    
+    self->data->content = NULL;
+    spSkeletonBinary_dispose(self);
+    free(src);
+    free(expected);
+    free(actual);
+    
+    return failed;
+}
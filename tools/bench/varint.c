@@ -0,0 +1,137 @@
+//
+// $id: varint.c https://github.com/zhongfq/spine-binaryreader $
+//
+
+// checks readVarint against a byte by byte decoder at every offset of a
+// skeleton file and of random buffers, then times skipSkin over the file's
+// skins, where weighted meshes read a varint per vertex and bone. build it
+// twice, as varint and as varint-bytewise with SKELETONBINARY_NO_FAST_VARINT,
+// and compare the timings.
+//
+//   varint <file.skel>
+
+#include "SkeletonBinary.c"
+
+#define RANDOM_LENGTH   (1024 * 1024)
+#define SKIN_BYTES      (256 * 1024 * 1024)
+
+// the decoder from before the 8 byte fast path, reads past the end as 0
+static int readVarintBytewise(const unsigned char *content, int length, int *position, bool optimizePositive)
+{
+    unsigned int result = 0;
+    
+    for (int shift = 0; shift < 35; shift += 7) {
+        int b = *position < length ? content[(*position)++] : 0;
+        result |= (unsigned int)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+    }
+    return (int)(optimizePositive ? result : ((result >> 1) ^ -(result & 1)));
+}
+
+// returns the number of offsets where value or new position differ
+static int compareVarints(spSkeletonBinary *self, const unsigned char *content, int length)
+{
+    int mismatches = 0;
+    
+    self->data->content = (char *)content;
+    self->data->capacity = length;
+    for (int i = 0; i < length; i++) {
+        for (int positive = 0; positive < 2; positive++) {
+            int position = i;
+            int expected = readVarintBytewise(content, length, &position, positive);
+            int actual;
+            
+            self->data->position = i;
+            actual = readVarint(self, positive);
+            if (actual != expected || self->data->position != position) {
+                if (mismatches++ < 8) {
+                    printf("offset %d: %d at %d, expected %d at %d\n", i, actual, self->data->position, expected, position);
+                }
+            }
+        }
+    }
+    
+    return mismatches;
+}
+
+// header up to the default skin, then every skin once
+static void skipSkins(spSkeletonBinary *self, int skinsStart)
+{
+    self->data->position = skinsStart;
+    skipSkin(self, NULL);
+    for (int i = 0, n = readVarint(self, true); i < n; i++) {
+        skipString(self);
+        skipSkin(self, NULL);
+    }
+    resetStringBuffers(self);
+}
+
+int main(int argc, char *argv[])
+{
+    spSkeletonBinary *self;
+    unsigned char *random;
+    char *content;
+    bool mapped;
+    int length, skinsStart, skinsLength, passes, mismatches;
+    int64_t best = INT64_MAX;
+    
+    if (argc < 2 || (content = openImage(argv[1], &length, &mapped)) == NULL) {
+        fprintf(stderr, "usage: %s <file.skel>\n", argv[0]);
+        return 1;
+    }
+    self = createSkeletonBinary(NULL, 1);
+    
+    // varints with every length, runs of continuation bytes and the tail
+    // end where the fast path falls back
+    random = (unsigned char *)malloc(RANDOM_LENGTH);
+    srand(1);
+    for (int i = 0; i < RANDOM_LENGTH; i++) {
+        random[i] = (unsigned char)(rand() % 3 ? rand() | 0x80 : rand() & 0x7F);
+    }
+    mismatches = compareVarints(self, random, RANDOM_LENGTH);
+    mismatches += compareVarints(self, (const unsigned char *)content, length);
+    free(random);
+    
+    self->data->content = content;
+    self->data->capacity = length;
+    self->data->position = 0;
+    skipString(self);
+    skipString(self);
+    readFloat(self);
+    readFloat(self);
+    readFormat(self);
+    if (self->toc) {
+        self->data->position = self->toc->sections[SECTION_DEFAULT_SKIN];
+    } else {
+        skipToDefaultSkin(self);
+    }
+    skinsStart = self->data->position;
+    skipSkins(self, skinsStart);
+    skinsLength = MAX(self->data->position - skinsStart, 1);
+    passes = MAX(SKIN_BYTES / skinsLength, 1);
+    
+    for (int round = 0; round < 5; round++) {
+        int64_t start = getMicroseconds();
+        for (int i = 0; i < passes; i++) {
+            skipSkins(self, skinsStart);
+        }
+        best = MIN(best, getMicroseconds() - start);
+    }
+    
+#ifdef SKELETONBINARY_FAST_VARINT
+    printf("readVarint: 8 byte loads\n");
+#else
+    printf("readVarint: byte by byte\n");
+#endif
+    printf("equivalence: %s\n", mismatches == 0 ? "ok" : "MISMATCH");
+    printf("skipSkin: %d bytes of skins, %.2f us per pass, %.1f MB/s\n",
+           skinsLength, (double)best / passes, (double)skinsLength * passes / (double)MAX(best, 1));
+    
+    self->data->content = NULL;
+    spSkeletonBinary_dispose(self);
+    closeImage(content, length, mapped);
+    
+    return mismatches != 0;
+}
@@ -11,6 +11,12 @@ case "`uname`" in
         ;;
 esac
 
+# spinec isn't checked in, build it on first use
+if test ! -x $SPINEC
+then
+    make -C $WORKPATH/spine-cli spine || exit 1
+fi
+
 for file in `find . -name "*.json"`
 do
     if test -f $file
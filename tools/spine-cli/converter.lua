@@ -65,7 +65,12 @@ local function writeFloat(value)
 end
 
 local function writeString(value)
-    binarywriter:string(value)
+    -- a spinewriter without cstring support reads the last argument as the string
+    if option.cstrings then
+        binarywriter:string(value, true)
+    else
+        binarywriter:string(value)
+    end
 end
 
 local function writeColor(color)
@@ -78,16 +83,39 @@ local function writeRawFloats(floats)
     end
 end
 
+-- bulk arrays, little endian and 16 byte aligned in the native layout
+local function writeFloatArray(floats)
+    if option.native then
+        binarywriter:align(16)
+        for _, value in ipairs(floats) do
+            binarywriter:float(value, true)
+        end
+    else
+        writeRawFloats(floats)
+    end
+end
+
+local function writeShortArray(shorts)
+    if option.native then
+        binarywriter:align(16)
+        for _, value in ipairs(shorts) do
+            binarywriter:short(value, true)
+        end
+    else
+        writeRawShorts(shorts)
+    end
+end
+
 local function writeFloats(floats)
     floats = floats or {}
     writeVarint(#floats, true)
-    writeRawFloats(floats)
+    writeFloatArray(floats)
 end
 
 local function writeShorts(shorts)
     shorts = shorts or {}
     writeVarint(#shorts, true)
-    writeRawShorts(shorts)
+    writeShortArray(shorts)
 end
 
 local function getSortedNames(t)
@@ -344,15 +372,247 @@ local function makeupTimelines()
 end
 
 -------------------------------------------------------------------------------
+-- quantized timeline values, each timeline stores the range of its values
+-- followed by 8 or 16 bit fractions of it
+local quantizer = {min = 0, max = 0}
+
+local function float32(value)
+    return string.unpack("f", string.pack("f", value))
+end
+
+local function writeQuantizer(values)
+    if option.quantize == 0 then
+        return
+    end
+    local min, max = math.huge, -math.huge
+    for _, value in ipairs(values) do
+        min = math.min(min, value)
+        max = math.max(max, value)
+    end
+    if #values == 0 then
+        min, max = 0, 0
+    end
+    quantizer.min, quantizer.max = float32(min), float32(max)
+    writeFloat(quantizer.min)
+    writeFloat(quantizer.max)
+end
+
+local function writeValue(value)
+    if option.quantize == 0 then
+        writeFloat(value)
+        return
+    end
+    local steps = (1 << option.quantize) - 1
+    local q = 0
+    if quantizer.max > quantizer.min then
+        q = math.floor((value - quantizer.min) / (quantizer.max - quantizer.min) * steps + 0.5)
+        q = math.max(0, math.min(steps, q))
+    end
+    if option.quantize == 8 then
+        writeByte(q)
+    else
+        writeShort(q)
+    end
+end
+
+-- collects the values a timeline writes, fields are {name, default} pairs
+local function getTimelineValues(timeline, fields)
+    local values = {}
+    for _, frame in ipairs(timeline) do
+        for _, field in ipairs(fields) do
+            local value = frame[field[1]]
+            if value == nil then
+                value = field[2]
+            end
+            values[#values + 1] = value
+        end
+    end
+    return values
+end
+
+-- keyframe times as varint tick deltas, each animation picks the first rate
+-- its keyframes sit on (within the json rounding) or 0 to keep float times
+local TICK_RATES = {30, 60, 24, 25, 50, 120}
+local ticks = {rate = 0, last = 0}
+
+local function toTicks(time, rate)
+    return math.floor(time * rate + 0.5)
+end
+
+local function fitsTickRate(value, rate)
+    if type(value) ~= "table" then
+        return true
+    end
+    local last = 0
+    for i, v in ipairs(value) do
+        if type(v) == "table" and type(v.time) == "number" then
+            local tick = toTicks(v.time, rate)
+            if math.abs(tick / rate - v.time) > 0.0005 or (i > 1 and tick < last) then
+                return false
+            end
+            last = tick
+        end
+    end
+    for _, v in pairs(value) do
+        if not fitsTickRate(v, rate) then
+            return false
+        end
+    end
+    return true
+end
+
+local function getTickRate(animation)
+    if not option.ticks then
+        return 0
+    end
+    for _, rate in ipairs(TICK_RATES) do
+        if fitsTickRate(animation, rate) then
+            return rate
+        end
+    end
+    return 0
+end
+
+local function writeTickRate(animation)
+    if option.ticks then
+        ticks.rate = getTickRate(animation)
+        writeVarint(ticks.rate, true)
+    end
+end
+
+-- frameIndex 1 starts a timeline, its ticks count from 0
+local function writeTime(time, frameIndex)
+    if ticks.rate == 0 then
+        writeFloat(time)
+        return
+    end
+    if frameIndex == 1 then
+        ticks.last = 0
+    end
+    local tick = toTicks(time, ticks.rate)
+    writeVarint(tick - ticks.last, true)
+    ticks.last = tick
+end
+
 -- header
 -------------------------------------------------------------------------------
+local FORMAT_CSTRINGS = 0x02
+local FORMAT_TOC = 0x04
+local FORMAT_NATIVE = 0x08
+local FORMAT_QUANTIZED = 0x10
+local FORMAT_TICKS = 0x20
+
 local function writeHeader()
     data.skeleton = data.skeleton or {}
-    writeString(data.skeleton.hash)
-    writeString(data.skeleton.spine) -- version
+    -- written before the format flags, always length prefixed
+    binarywriter:string(data.skeleton.hash)
+    binarywriter:string(data.skeleton.spine) -- version
     writeFloat(data.skeleton.width or 0)
     writeFloat(data.skeleton.height or 0)
-    writeBool(false)
+    
+    -- format flags, bit 0 is the nonessential flag
+    local flags = 0
+    if option.cstrings then
+        flags = flags | FORMAT_CSTRINGS
+    end
+    if option.toc then
+        flags = flags | FORMAT_TOC
+    end
+    if option.native then
+        flags = flags | FORMAT_NATIVE
+    end
+    if option.quantize ~= 0 then
+        flags = flags | FORMAT_QUANTIZED
+    end
+    if option.ticks then
+        flags = flags | FORMAT_TICKS
+    end
+    writeByte(flags)
+    if option.quantize ~= 0 then
+        writeByte(option.quantize)
+    end
+end
+
+-------------------------------------------------------------------------------
+-- table of contents
+-------------------------------------------------------------------------------
+local Section = {
+    bones       = 0,
+    slots       = 1,
+    ik          = 2,
+    transform   = 3,
+    path        = 4,
+    defaultSkin = 5,
+    skins       = 6,
+    events      = 7,
+    animations  = 8,
+}
+local SECTION_COUNT = 9
+
+local toc
+
+-- the latest key time of any timeline, same as the runtime's duration
+local function getDuration(value)
+    local duration = 0
+    if type(value) == "table" then
+        for k, v in pairs(value) do
+            if k == "time" and type(v) == "number" then
+                duration = math.max(duration, v)
+            else
+                duration = math.max(duration, getDuration(v))
+            end
+        end
+    end
+    return duration
+end
+
+-- absolute offsets are written as 0 first and patched once the entry is written
+local function writeOffsetPlaceholder(entries, key)
+    entries[key] = binarywriter:tell()
+    writeInt(0)
+end
+
+local function markOffset(entries, key)
+    if toc then
+        binarywriter:patch(toc[entries][key], binarywriter:tell())
+    end
+end
+
+local function writeTableOfContents()
+    if not option.toc then
+        return
+    end
+
+    toc = {sections = {}, skins = {}, animations = {}}
+
+    for i = 0, SECTION_COUNT - 1 do
+        writeOffsetPlaceholder(toc.sections, i)
+    end
+
+    local names = {}
+    for _, name in ipairs(getSortedNames(data.skins)) do
+        if name ~= "default" then
+            names[#names + 1] = name
+        end
+    end
+    writeVarint(#names, true)
+    for _, name in ipairs(names) do
+        writeOffsetPlaceholder(toc.skins, name)
+    end
+
+    names = getSortedNames(data.animations)
+    writeVarint(#names, true)
+    for _, name in ipairs(names) do
+        writeOffsetPlaceholder(toc.animations, name)
+        -- snapped to the grid the reader rebuilds the keyframe times from
+        local animation = data.animations[name]
+        local duration = getDuration(animation)
+        local rate = getTickRate(animation)
+        if rate ~= 0 then
+            duration = toTicks(duration, rate) / rate
+        end
+        writeFloat(duration)
+    end
 end
 
 -------------------------------------------------------------------------------
@@ -503,7 +763,7 @@ end
 local function writeVertices(vertices, verticesLength)
     if #vertices == verticesLength then
         writeBool(false)
-        writeRawFloats(vertices)
+        writeFloatArray(vertices)
     else
         writeBool(true)
         local i = 1
@@ -551,7 +811,7 @@ local function writeAttachment(attachment)
         writeString(attachment.path)
         writeColor(attachment.color)
         writeVarint(vertexCount, true)
-        writeRawFloats(attachment.uvs)
+        writeFloatArray(attachment.uvs)
         writeShorts(attachment.triangles)
         writeVertices(attachment.vertices, #attachment.uvs)
         writeVarint((attachment.hull or 0) >> 1, true)
@@ -571,7 +831,7 @@ local function writeAttachment(attachment)
         writeBool(optionalBool(attachment.constantSpeed, 1))
         writeVarint(vertexCount, true)
         writeVertices(attachment.vertices, attachment.vertexCount << 1)
-        writeRawFloats(attachment.lengths)
+        writeFloatArray(attachment.lengths)
     else
         assert(false, "unknown attachment type: " .. attachment.type)
     end
@@ -600,10 +860,13 @@ local function writeSkins()
     local default = skins.default
     skins.default = nil
 
+    markOffset("sections", Section.skins)
+
     local names = getSortedNames(skins)
     writeVarint(#names, true)
     for i, name in ipairs(names) do
         if name ~= "default" then
+            markOffset("skins", name)
             writeString(name)
             writeSkin(skins[name])
         end
@@ -676,13 +939,13 @@ local function writeAnimationSlots(slots)
             writeByte(TimelineType[name])
             writeVarint(#timeline, true)
             if name == "attachment" then
-                for _, frame in ipairs(timeline) do
-                    writeFloat(frame.time or 0)
+                for i, frame in ipairs(timeline) do
+                    writeTime(frame.time or 0, i)
                     writeString(frame.name)
                 end
             elseif name == "color" then
                 for i, frame in ipairs(timeline) do
-                    writeFloat(frame.time or 0)
+                    writeTime(frame.time or 0, i)
                     writeColor(frame.color)
                     if i < #timeline then
                         writeCurve(frame.curve)
@@ -705,18 +968,20 @@ local function writeAnimationBones(bones)
             writeByte(TimelineType[name])
             writeVarint(#timeline, true)
             if name == "rotate" then
+                writeQuantizer(getTimelineValues(timeline, {{"angle", 0}}))
                 for i, frame in ipairs(timeline) do
-                    writeFloat(frame.time or 0)
-                    writeFloat(frame.angle or 0)
+                    writeTime(frame.time or 0, i)
+                    writeValue(frame.angle or 0)
                     if i < #timeline then
                         writeCurve(frame.curve)
                     end
                 end  
             elseif name == "translate" or name == "scale" or name == "shear" then
+                writeQuantizer(getTimelineValues(timeline, {{"x", 0}, {"y", 0}}))
                 for i, frame in ipairs(timeline) do
-                    writeFloat(frame.time or 0)
-                    writeFloat(frame.x or 0)
-                    writeFloat(frame.y or 0)
+                    writeTime(frame.time or 0, i)
+                    writeValue(frame.x or 0)
+                    writeValue(frame.y or 0)
                     if i < #timeline then
                         writeCurve(frame.curve)
                     end
@@ -735,9 +1000,10 @@ local function writeAnimationIKs(iks)
         local timeline = iks[name]
         writeVarint(ikname2idx[name], true)
         writeVarint(#timeline, true)
+        writeQuantizer(getTimelineValues(timeline, {{"mix", 1}}))
         for i, frame in ipairs(timeline) do
-            writeFloat(frame.time or 0)
-            writeFloat(frame.mix or 1)
+            writeTime(frame.time or 0, i)
+            writeValue(frame.mix or 1)
             writeByte(frame.bendPositive ~= false and 1 or -1)
             if i < #timeline then
                 writeCurve(frame.curve)
@@ -753,12 +1019,14 @@ local function writeAnimationTransformConstraints(transforms)
         local timeline = transforms[name]
         writeVarint(transformname2idx[name], true)
         writeVarint(#timeline, true)
+        writeQuantizer(getTimelineValues(timeline,
+            {{"rotateMix", 1}, {"translateMix", 1}, {"scaleMix", 1}, {"shearMix", 1}}))
         for i, frame in ipairs(timeline) do
-            writeFloat(frame.time or 0)
-            writeFloat(frame.rotateMix or 1)
-            writeFloat(frame.translateMix or 1)
-            writeFloat(frame.scaleMix or 1)
-            writeFloat(frame.shearMix or 1)
+            writeTime(frame.time or 0, i)
+            writeValue(frame.rotateMix or 1)
+            writeValue(frame.translateMix or 1)
+            writeValue(frame.scaleMix or 1)
+            writeValue(frame.shearMix or 1)
             if i < #timeline then
                 writeCurve(frame.curve)
             end
@@ -778,18 +1046,20 @@ local function writeAnimationPathConstraints(paths)
             writeByte(TimelineType[name])
             writeVarint(#timeline, true)
             if name == "position" or name == "spacing" then
+                writeQuantizer(getTimelineValues(timeline, {{name, 0}}))
                 for i, frame in ipairs(timeline) do
-                    writeFloat(frame.time or 0)
-                    writeFloat(frame[name] or 0)
+                    writeTime(frame.time or 0, i)
+                    writeValue(frame[name] or 0)
                     if i < #timeline then
                         writeCurve(frame.curve)
                     end
                 end
             elseif name == "mix" then
+                writeQuantizer(getTimelineValues(timeline, {{"rotateMix", 1}, {"translateMix", 1}}))
                 for i, frame in ipairs(timeline) do
-                    writeFloat(frame.time or 0)
-                    writeFloat(frame.rotateMix or 1)
-                    writeFloat(frame.translateMix or 1)
+                    writeTime(frame.time or 0, i)
+                    writeValue(frame.rotateMix or 1)
+                    writeValue(frame.translateMix or 1)
                     if i < #timeline then
                         writeCurve(frame.curve)
                     end
@@ -814,13 +1084,26 @@ local function writeAnimationDeforms(deforms)
                 local timeline = deforms[skin][slot][name]
                 writeString(name)
                 writeVarint(#timeline, true)
+                if option.quantize ~= 0 then
+                    local values = {}
+                    for _, frame in ipairs(timeline) do
+                        table.move(frame.vertices or {}, 1, #(frame.vertices or {}), #values + 1, values)
+                    end
+                    writeQuantizer(values)
+                end
                 for i, frame in ipairs(timeline) do
                     frame.vertices = frame.vertices or {}
-                    writeFloat(frame.time or 0)
+                    writeTime(frame.time or 0, i)
                     writeVarint(#frame.vertices, true)
                     if #frame.vertices > 0 then
                         writeVarint(frame.offset or 0, true)
-                        writeRawFloats(frame.vertices)
+                        if option.quantize ~= 0 then
+                            for _, value in ipairs(frame.vertices) do
+                                writeValue(value)
+                            end
+                        else
+                            writeFloatArray(frame.vertices)
+                        end
                     end
                     if i < #timeline then
                         writeCurve(frame.curve)
@@ -833,9 +1116,9 @@ end
 
 local function writeAnimationDraworder(draworder)
     writeVarint(#draworder, true)
-    for _, frame in ipairs(draworder) do
+    for i, frame in ipairs(draworder) do
         local offsets = frame.offsets or {}
-        writeFloat(frame.time or 0)
+        writeTime(frame.time or 0, i)
         writeVarint(#offsets, true)
         for _, offset in ipairs(offsets) do
             writeVarint(slotname2idx[offset.slot], true)
@@ -846,8 +1129,8 @@ end
 
 local function writeAnimationEvents(events)
     writeVarint(#events, true)
-    for _, frame in ipairs(events) do
-        writeFloat(frame.time or 0)
+    for i, frame in ipairs(events) do
+        writeTime(frame.time or 0, i)
         writeVarint(eventname2idx[frame.name], true)
         writeVarint(frame.int or 0, false)
         writeFloat(frame.float or 0)
@@ -859,6 +1142,7 @@ local function writeAnimationEvents(events)
 end
 
 local function writeAnimation(animation)
+    writeTickRate(animation)
     writeAnimationSlots(animation.slots or {})
     writeAnimationBones(animation.bones or {})
     writeAnimationIKs(animation.ik or {})
@@ -874,6 +1158,7 @@ local function writeAnimations()
     local names = getSortedNames(animations)
     writeVarint(#names, true)
     for _, name in ipairs(names) do
+        markOffset("animations", name)
         writeString(name)
         writeAnimation(animations[name])
     end
@@ -887,19 +1172,34 @@ local function readData(jsonfile)
 end
 
 function main(jsonfile, skelfile, cmdoption)
+    -- a spinec built before an option existed leaves it out of the table
     option = cmdoption
+    option.cstrings = option.cstrings == true
+    option.toc = option.toc == true
+    option.native = option.native == true
+    option.quantize = option.quantize or 0
+    option.ticks = option.ticks == true
     data = readData(jsonfile)
     binarywriter = spinewriter.new(skelfile)
     initNameIndex()
     trimSlotTimelines()
     makeupTimelines()
     writeHeader()
+    writeTableOfContents()
+    markOffset("sections", Section.bones)
     writeBones()
+    markOffset("sections", Section.slots)
     writeSlots()
+    markOffset("sections", Section.ik)
     writeIKs()
+    markOffset("sections", Section.transform)
     writeTransformConstraints()
+    markOffset("sections", Section.path)
     writePathConstraints()
+    markOffset("sections", Section.defaultSkin)
     writeSkins()
+    markOffset("sections", Section.events)
     writeEvents()
+    markOffset("sections", Section.animations)
     writeAnimations()
 end
\ No newline at end of file
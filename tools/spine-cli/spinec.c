@@ -52,6 +52,11 @@ int main(int argc, const char *argv[])
     bool option_makeup = false;
     bool option_trim = false;
     bool option_nonessential = false;
+    bool option_cstrings = false;
+    bool option_toc = false;
+    bool option_native = false;
+    int option_quantize = 0;
+    bool option_ticks = false;
     
     for (int i = 1; i < argc; i++) {
         const char *op = argv[i];
@@ -68,6 +73,22 @@ int main(int argc, const char *argv[])
         if (isop("-e", op)) {
             option_nonessential = true;
         }
+        if (isop("-z", op)) {
+            option_cstrings = true;
+        }
+        if (isop("-t", op)) {
+            option_toc = true;
+        }
+        if (isop("-n", op)) {
+            option_native = true;
+        }
+        if (isop("-q", op)) {
+            const char *bits = get_arg(argc, argv, &i);
+            option_quantize = bits != NULL && atoi(bits) == 8 ? 8 : 16;
+        }
+        if (isop("-k", op)) {
+            option_ticks = true;
+        }
     }
     
     if (skelfile == NULL) {
@@ -117,7 +138,7 @@ int main(int argc, const char *argv[])
     lua_pushstring(L, jsonfile);
     lua_pushstring(L, skelfile);
     
-    lua_createtable(L, 0, 2);
+    lua_createtable(L, 0, 8);
     
     lua_pushboolean(L, option_makeup);
     lua_setfield(L, -2, "makeup");
@@ -128,6 +149,21 @@ int main(int argc, const char *argv[])
     lua_pushboolean(L, option_nonessential);
     lua_setfield(L, -2, "nonessential");
     
+    lua_pushboolean(L, option_cstrings);
+    lua_setfield(L, -2, "cstrings");
+    
+    lua_pushboolean(L, option_toc);
+    lua_setfield(L, -2, "toc");
+    
+    lua_pushboolean(L, option_native);
+    lua_setfield(L, -2, "native");
+    
+    lua_pushinteger(L, option_quantize);
+    lua_setfield(L, -2, "quantize");
+    
+    lua_pushboolean(L, option_ticks);
+    lua_setfield(L, -2, "ticks");
+    
     lua_pcall(L, 3, 0, errfunc);
     
     lua_close(L);
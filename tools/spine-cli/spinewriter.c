@@ -63,17 +63,23 @@ static int _write_byte(lua_State *L)
     return 0;
 }
 
-static void write_short(spinewriter *self, int value)
+static void write_short(spinewriter *self, int value, bool littleEndian)
 {
-    PUT(value >> 8 & 0xFF);
-    PUT(value & 0xFF);
+    if (littleEndian) {
+        PUT(value & 0xFF);
+        PUT(value >> 8 & 0xFF);
+    } else {
+        PUT(value >> 8 & 0xFF);
+        PUT(value & 0xFF);
+    }
 }
 
 static int _write_short(lua_State *L)
 {
+    lua_settop(L, 3);
     spinewriter *self = GETWRITER();
     int value = (int)luaL_checkinteger(L, 2);
-    write_short(self, value);
+    write_short(self, value, lua_toboolean(L, 3));
     return 0;
 }
 
@@ -107,16 +113,26 @@ static int _write_varint(lua_State *L)
     return 0;
 }
 
+static void write_int(spinewriter *self, int value, bool littleEndian)
+{
+    if (littleEndian) {
+        PUT(value & 0xFF);
+        PUT(value >> 8  & 0xFF);
+        PUT(value >> 16 & 0xFF);
+        PUT(value >> 24 & 0xFF);
+    } else {
+        PUT(value >> 24 & 0xFF);
+        PUT(value >> 16 & 0xFF);
+        PUT(value >> 8  & 0xFF);
+        PUT(value & 0xFF);
+    }
+}
+
 static int _write_int(lua_State *L)
 {
     spinewriter *self = GETWRITER();
     int value = (int)luaL_checkinteger(L, 2);
-    
-    PUT(value >> 24 & 0xFF);
-    PUT(value >> 16 & 0xFF);
-    PUT(value >> 8  & 0xFF);
-    PUT(value & 0xFF);
-    
+    write_int(self, value, false);
     return 0;
 }
 
@@ -127,32 +143,73 @@ static int _write_float(lua_State *L)
         int i;
     } u;
     
+    lua_settop(L, 3);
+    spinewriter *self = GETWRITER();
     u.f = (float)luaL_checknumber(L, 2);
-    
-    lua_settop(L, 1);
-    lua_pushinteger(L, u.i);
+    write_int(self, u.i, lua_toboolean(L, 3));
 
-    return _write_int(L);
+    return 0;
+}
+
+// pads with zeros up to the next multiple of the given alignment
+static int _align(lua_State *L)
+{
+    spinewriter *self = GETWRITER();
+    long alignment = (long)luaL_checkinteger(L, 2);
+    
+    while (ftell(self->file) % alignment != 0) {
+        PUT(0);
+    }
+    
+    return 0;
 }
 
 static int _write_string(lua_State *L)
 {
+    lua_settop(L, 3);
     spinewriter *self = GETWRITER();
-    const char *str = lua_tostring(L, -1);
+    const char *str = lua_tostring(L, 2);
+    bool cstring = lua_toboolean(L, 3);
     
     if (str == NULL) {
         write_varint(self, 0, true);
-    } else if (strlen(str) == 0) {
-        write_varint(self, 1, true);
     } else {
         int len = (int)strlen(str);
         write_varint(self, len + 1, true);
         fwrite(str, sizeof(char), len, self->file);
+        if (cstring) {
+            // the length still counts one byte for the terminator
+            PUT('\0');
+        }
     }
     
     return 0;
 }
 
+static int _tell(lua_State *L)
+{
+    spinewriter *self = GETWRITER();
+    lua_pushinteger(L, (lua_Integer)ftell(self->file));
+    return 1;
+}
+
+// overwrites the 4 byte int at offset, for values only known later
+static int _patch(lua_State *L)
+{
+    spinewriter *self = GETWRITER();
+    long offset = (long)luaL_checkinteger(L, 2);
+    int value = (int)luaL_checkinteger(L, 3);
+    
+    fseek(self->file, offset, SEEK_SET);
+    PUT(value >> 24 & 0xFF);
+    PUT(value >> 16 & 0xFF);
+    PUT(value >> 8  & 0xFF);
+    PUT(value & 0xFF);
+    fseek(self->file, 0, SEEK_END);
+    
+    return 0;
+}
+
 static const luaL_Reg spinelib[] = {
     {"new", _new},
     {"__gc", _gc},
@@ -163,6 +220,9 @@ static const luaL_Reg spinelib[] = {
     {"varint", _write_varint},
     {"float", _write_float},
     {"string", _write_string},
+    {"align", _align},
+    {"tell", _tell},
+    {"patch", _patch},
     {NULL, NULL},
 };
 